@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "../include/batch_lexer.h"
+#include "../include/lexer.h"
+#include "../include/pipeline.h"
+#include "../include/sjl.h"
+#include "../include/summary.h"
+#include "../include/token_buffer.h"
+
+/**
+ * Throughput benchmarks for the lexer.
+ *
+ * Every benchmark reports bytes per second, tokens per second and the number of heap
+ * allocations per run. Besides the synthetic workloads, `--corpus=<directory>` adds the
+ * `.java` files found under a directory, lexed one after another in every run.
+ *
+ * In builds with `SIMPLEJAVALEXER_LEXER_STATS`, the per-state counters of every benchmark
+ * are printed after all benchmarks have run.
+ */
+
+std::atomic<size_t> allocationCount{0};  // Number of allocations by any form of `operator new` so far.
+
+/**
+ * Counts and performs an allocation for the replaced forms of `operator new`.
+ * @return The memory, or nullptr if it cannot be allocated.
+ */
+void *countedAllocate(size_t size) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+/**
+ * Counts and performs an allocation for the replaced aligned forms of `operator new`.
+ * @return The memory, or nullptr if it cannot be allocated.
+ */
+void *countedAllocate(size_t size, std::align_val_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    // `aligned_alloc` requires the size to be a multiple of the alignment.
+    auto align = (size_t) alignment;
+    return std::aligned_alloc(align, (std::max(size, (size_t) 1) + align - 1) / align * align);
+}
+
+void *operator new(size_t size) {
+    if (void *pointer = countedAllocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    if (void *pointer = countedAllocate(size, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+/**
+ * Frees memory of any replaced form of `operator new`, which all come from `malloc` or
+ * `aligned_alloc`. Kept out of line, so the compiler never sees `free` called on memory from
+ * `operator new` where a delete is inlined, which it would warn about.
+ */
+__attribute__((noinline)) void releaseAllocation(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+    releaseAllocation(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+    releaseAllocation(pointer);
+}
+
+/**
+ * Repeats a generated snippet until the result has at least `size` bytes.
+ */
+std::string repeatUntil(size_t size, const std::function<std::string(int)> &snippet) {
+    std::string result;
+    for (int i = 0; result.size() < size; i++) {
+        result += snippet(i);
+    }
+    return result;
+}
+
+constexpr size_t workload_size = 1 << 20;
+
+std::string commentHeavy() {
+    return repeatUntil(workload_size, [](int i) {
+        return "/**\n * Returns the value of field " + std::to_string(i) + ".\n *\n * @return the value\n */\n"
+               "int get" + std::to_string(i) + "() { return v; } // trailing comment " + std::to_string(i) + "\n";
+    });
+}
+
+std::string numberHeavy() {
+    return repeatUntil(workload_size, [](int i) {
+        return "double[] d" + std::to_string(i) + " = {1_000_000, 0x1F_FFL, 0b1010_1010, 017, 3.14159e-2f, "
+               ".5d, 6.022_140_76e23, " + std::to_string(i * 7919) + "L};\n";
+    });
+}
+
+std::string operatorDense() {
+    return repeatUntil(workload_size, [](int) {
+        return std::string("a+=b<<c>>>d;e>>>=f!=g&&h||i?j:k;l^=m%n*o/p;q=r++-s--;t::u;v->w;x<=y>=z==0;\n");
+    });
+}
+
+std::string hugeSingleLine() {
+    return repeatUntil(workload_size, [](int i) {
+        return "int v" + std::to_string(i) + " = call(a, \"text\", 'c') + 42; ";
+    });
+}
+
+std::string nestedBlockComments() {
+    // Block comments do not nest in Java, so every opener inside is only comment text.
+    return repeatUntil(workload_size, [](int i) {
+        std::string comment = "/*";
+        for (int depth = 0; depth < 64; depth++) {
+            comment += " /* level " + std::to_string(depth) + (depth % 8 == 7 ? " *\n" : " * /");
+        }
+        return comment + " */ class C" + std::to_string(i) + " {}\n";
+    });
+}
+
+std::string unicodeIdentifiers() {
+    return repeatUntil(workload_size, [](int i) {
+        return "Größe größe" + std::to_string(i) + " = new Größe(名前, \\u00e9t\\u00e9, \"Grüße\"); // Übersicht\n";
+    });
+}
+
+std::string textBlocks() {
+    return repeatUntil(workload_size, [](int i) {
+        return "String query" + std::to_string(i) + " = \"\"\"\n    SELECT \"name\", \"size\" -- \\\"\"\"quoted\\\"\"\"\n" +
+               "    FROM files WHERE size > " + std::to_string(i) + "\n    \"\"\";\n";
+    });
+}
+
+/**
+ * Generated files, e.g. from an IDL compiler, whose lines mostly repeat within and across files.
+ */
+std::vector<std::string> generatedFiles() {
+    std::vector<std::string> files;
+    for (int file = 0; file < 64; file++) {
+        files.push_back("public final class Message" + std::to_string(file) + " {\n" +
+                        repeatUntil(workload_size / 64, [](int i) {
+                            return "    // Field " + std::to_string(i % 8) + ".\n"
+                                   "    @java.lang.Override\n"
+                                   "    public boolean hasValue() {\n"
+                                   "        return ((bitField0_ & 0x00000001) != 0);\n"
+                                   "    }\n"
+                                   "\n";
+                        }) + "}\n");
+    }
+    return files;
+}
+
+std::map<std::string, LexerStats> statsByBenchmark;  // Lexer counters of the last run of every benchmark.
+std::map<std::string, uint64_t> statsRuns;           // Number of runs behind `statsByBenchmark`.
+
+/**
+ * Prints the lexer counters of one benchmark, one row per state that did any work.
+ */
+void printLexerStats(const std::string &name, const LexerStats &stats, uint64_t runs) {
+    double totalCycles = 0;
+    for (size_t i = 0; i < tokenizer_state_count; i++) {
+        totalCycles += stats.estimatedCycles((TokenizerState) i);
+    }
+    std::printf("\n%s (per run)\n%-22s %12s %10s %12s %14s %8s %10s\n", name.c_str(), "State", "Bytes",
+                "Tokens", "Redispatches", "Cycles", "Share", "Cycles/B");
+    for (size_t i = 0; i < tokenizer_state_count; i++) {
+        auto state = (TokenizerState) i;
+        if (stats.steps[i] == 0) {
+            continue;
+        }
+        double cycles = stats.estimatedCycles(state);
+        std::printf("%-22s %12.0f %10.0f %12.0f %14.0f %7.1f%% %10.2f\n",
+                    std::string(getTokenizerStateName(state)).c_str(), (double) stats.bytes[i] / runs,
+                    (double) stats.tokens[i] / runs, (double) stats.redispatches[i] / runs, cycles / runs,
+                    totalCycles == 0 ? 0 : 100 * cycles / totalCycles,
+                    stats.bytes[i] == 0 ? 0 : cycles / (double) stats.bytes[i]);
+    }
+}
+
+/**
+ * Runs one way of lexing over a set of sources and reports the counters of the suite.
+ */
+void runLexer(benchmark::State &state, const std::string &name, const std::vector<std::string> &sources,
+              const std::function<size_t(const std::string &)> &lex) {
+    size_t bytes = 0;
+    for (const std::string &source: sources) {
+        bytes += source.size();
+    }
+    size_t tokens = 0;
+    size_t allocations = allocationCount.load(std::memory_order_relaxed);
+    resetLexerStats();
+    for (auto _: state) {
+        tokens = 0;
+        for (const std::string &source: sources) {
+            tokens += lex(source);
+        }
+    }
+    allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+    if (lexer_stats_enabled) {
+        LexerStats stats = lexerStats();
+        statsByBenchmark[name] = stats;
+        statsRuns[name] = (uint64_t) state.iterations();
+    }
+
+    state.SetBytesProcessed((int64_t) (bytes * state.iterations()));
+    state.counters["tokens/s"] = benchmark::Counter((double) (tokens * state.iterations()),
+                                                    benchmark::Counter::kIsRate);
+    state.counters["allocs/run"] = benchmark::Counter((double) allocations / (double) state.iterations());
+}
+
+/**
+ * Registers the lexer benchmarks of one workload.
+ */
+void registerWorkload(const std::string &name, std::vector<std::string> sources) {
+    auto shared = std::make_shared<std::vector<std::string>>(std::move(sources));
+    benchmark::RegisterBenchmark((name + "/tokenize").c_str(), [name, shared](benchmark::State &state) {
+        runLexer(state, name + "/tokenize", *shared, [](const std::string &source) {
+            std::vector<Token> tokens = tokenize(source);
+            benchmark::DoNotOptimize(tokens.data());
+            return tokens.size();
+        });
+    });
+    benchmark::RegisterBenchmark((name + "/tokenize_view").c_str(), [name, shared](benchmark::State &state) {
+        runLexer(state, name + "/tokenize_view", *shared, [](const std::string &source) {
+            std::vector<TokenView> tokens = tokenize_view(source);
+            benchmark::DoNotOptimize(tokens.data());
+            return tokens.size();
+        });
+    });
+    benchmark::RegisterBenchmark((name + "/tokenize_view_dfa").c_str(), [name, shared](benchmark::State &state) {
+        runLexer(state, name + "/tokenize_view_dfa", *shared, [](const std::string &source) {
+            std::vector<TokenView> tokens = tokenize_view(source, {.engine = LexerEngine::DFA});
+            benchmark::DoNotOptimize(tokens.data());
+            return tokens.size();
+        });
+    });
+    benchmark::RegisterBenchmark((name + "/tokenizeCompact").c_str(), [name, shared](benchmark::State &state) {
+        runLexer(state, name + "/tokenizeCompact", *shared, [](const std::string &source) {
+            TokenBuffer tokens = tokenizeCompact(source);
+            benchmark::DoNotOptimize(&tokens);
+            return tokens.size();
+        });
+    });
+    benchmark::RegisterBenchmark((name + "/summarize").c_str(), [name, shared](benchmark::State &state) {
+        runLexer(state, name + "/summarize", *shared, [](const std::string &source) {
+            SourceSummary summary = summarize(source);
+            benchmark::DoNotOptimize(&summary);
+            return summary.tokens;
+        });
+    });
+    benchmark::RegisterBenchmark((name + "/sjl_tokenize_into").c_str(), [name, shared](benchmark::State &state) {
+        // One handle and one set of arrays are reused, as by a caller through an FFI.
+        std::shared_ptr<sjl_lexer> lexer(sjl_lexer_create(nullptr), sjl_free);
+        std::vector<uint8_t> types;
+        std::vector<uint32_t> offsets, lengths;
+        runLexer(state, name + "/sjl_tokenize_into", *shared, [&](const std::string &source) {
+            sjl_tokens tokens = {types.data(), offsets.data(), lengths.data(), nullptr, nullptr, types.size(), 0};
+            if (sjl_tokenize_into(lexer.get(), source.data(), source.size(), &tokens) == SJL_ERROR_CAPACITY) {
+                types.resize(tokens.count);
+                offsets.resize(tokens.count);
+                lengths.resize(tokens.count);
+                tokens = {types.data(), offsets.data(), lengths.data(), nullptr, nullptr, types.size(), 0};
+                sjl_copy_tokens(lexer.get(), &tokens);
+            }
+            benchmark::DoNotOptimize(types.data());
+            return tokens.count;
+        });
+    });
+}
+
+/**
+ * Registers the benchmarks of a batch of files lexed by `tokenizeAll`, with and without a line cache.
+ */
+void registerBatchWorkload(const std::string &name, std::vector<std::string> files) {
+    auto shared = std::make_shared<std::vector<std::string>>(std::move(files));
+    for (size_t lineCacheSize: {(size_t) 0, (size_t) 1 << 16}) {
+        std::string benchmarkName = name + (lineCacheSize > 0 ? "/tokenizeAll_lineCache" : "/tokenizeAll");
+        benchmark::RegisterBenchmark(benchmarkName.c_str(), [shared, lineCacheSize](benchmark::State &state) {
+            std::vector<std::string_view> sources(shared->begin(), shared->end());
+            size_t bytes = 0;
+            for (std::string_view source: sources) {
+                bytes += source.size();
+            }
+            size_t tokens = 0;
+            size_t allocations = allocationCount.load(std::memory_order_relaxed);
+            for (auto _: state) {
+                auto results = tokenizeAll(sources, {.lineCacheSize = lineCacheSize});
+                benchmark::DoNotOptimize(results.data());
+                tokens = 0;
+                for (const auto &result: results) {
+                    tokens += result.size();
+                }
+            }
+            allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+
+            state.SetBytesProcessed((int64_t) (bytes * state.iterations()));
+            state.counters["tokens/s"] = benchmark::Counter((double) (tokens * state.iterations()),
+                                                            benchmark::Counter::kIsRate);
+            state.counters["allocs/run"] = benchmark::Counter((double) allocations / (double) state.iterations());
+        })->UseRealTime();
+    }
+}
+
+/**
+ * Registers the benchmarks of a batch of files read from disk and lexed by `tokenizePipeline`,
+ * through io_uring and through I/O threads. The files are written to a temporary directory,
+ * which `main` removes; after the first run they are read from the page cache.
+ */
+void registerPipelineWorkload(const std::string &name, const std::vector<std::string> &files) {
+    auto directory = std::filesystem::temp_directory_path() / "simple_java_lexer_bench" / name;
+    std::filesystem::create_directories(directory);
+    auto paths = std::make_shared<std::vector<std::string>>();
+    size_t bytes = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        paths->push_back((directory / (std::to_string(i) + ".java")).string());
+        std::ofstream(paths->back(), std::ios::binary) << files[i];
+        bytes += files[i].size();
+    }
+    for (bool useIoUring: {true, false}) {
+        std::string benchmarkName = name + (useIoUring ? "/tokenizePipeline" : "/tokenizePipeline_ioThreads");
+        benchmark::RegisterBenchmark(benchmarkName.c_str(), [paths, bytes, useIoUring](benchmark::State &state) {
+            size_t tokens = 0;
+            size_t allocations = allocationCount.load(std::memory_order_relaxed);
+            for (auto _: state) {
+                PipelineStats stats = tokenizePipeline(*paths, [](TokenBlock &block) {
+                    benchmark::DoNotOptimize(block.tokens.data());
+                }, {.useIoUring = useIoUring});
+                tokens = stats.tokens;
+            }
+            allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+
+            state.SetBytesProcessed((int64_t) (bytes * state.iterations()));
+            state.counters["tokens/s"] = benchmark::Counter((double) (tokens * state.iterations()),
+                                                            benchmark::Counter::kIsRate);
+            state.counters["allocs/run"] = benchmark::Counter((double) allocations / (double) state.iterations());
+        })->UseRealTime();
+    }
+}
+
+/**
+ * Reads every `.java` file under a directory.
+ */
+std::vector<std::string> readCorpus(const std::string &directory) {
+    std::vector<std::string> sources;
+    for (const auto &entry: std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".java") {
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::stringstream contents;
+            contents << file.rdbuf();
+            sources.push_back(contents.str());
+        }
+    }
+    return sources;
+}
+
+int main(int argc, char **argv) {
+    // Take `--corpus=<directory>` out of the arguments before Google Benchmark parses them.
+    std::string corpus;
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string_view argument = argv[i];
+        if (argument.starts_with("--corpus=")) {
+            corpus = argument.substr(9);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    registerWorkload("CommentHeavy", {commentHeavy()});
+    registerWorkload("NumberHeavy", {numberHeavy()});
+    registerWorkload("OperatorDense", {operatorDense()});
+    registerWorkload("HugeSingleLine", {hugeSingleLine()});
+    registerWorkload("NestedBlockComments", {nestedBlockComments()});
+    registerWorkload("UnicodeIdentifiers", {unicodeIdentifiers()});
+    registerWorkload("TextBlocks", {textBlocks()});
+    registerBatchWorkload("GeneratedCode", generatedFiles());
+    registerPipelineWorkload("GeneratedCode", generatedFiles());
+    if (!corpus.empty()) {
+        registerWorkload("Corpus", readCorpus(corpus));
+        registerBatchWorkload("Corpus", readCorpus(corpus));
+        registerPipelineWorkload("Corpus", readCorpus(corpus));
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "simple_java_lexer_bench");
+    for (const auto &[name, stats]: statsByBenchmark) {
+        printLexerStats(name, stats, statsRuns[name]);
+    }
+    return 0;
+}
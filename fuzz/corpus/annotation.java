@@ -0,0 +1 @@
+@Test
\ No newline at end of file
@@ -0,0 +1,47 @@
+class C3 {
+    int f0 = 0x0; /* c */
+    int f1 = 0x1; /* c */
+    int f2 = 0x2; /* c */
+    int f3 = 0x3; /* c */
+    int f4 = 0x4; /* c */
+    int f5 = 0x5; /* c */
+    int f6 = 0x6; /* c */
+    int f7 = 0x7; /* c */
+    int f8 = 0x8; /* c */
+    int f9 = 0x9; /* c */
+    int f10 = 0x10; /* c */
+    int f11 = 0x11; /* c */
+    int f12 = 0x12; /* c */
+    int f13 = 0x13; /* c */
+    int f14 = 0x14; /* c */
+    int f15 = 0x15; /* c */
+    int f16 = 0x16; /* c */
+    int f17 = 0x17; /* c */
+    int f18 = 0x18; /* c */
+    int f19 = 0x19; /* c */
+    int f20 = 0x20; /* c */
+    int f21 = 0x21; /* c */
+    int f22 = 0x22; /* c */
+    int f23 = 0x23; /* c */
+    int f24 = 0x24; /* c */
+    int f25 = 0x25; /* c */
+    int f26 = 0x26; /* c */
+    int f27 = 0x27; /* c */
+    int f28 = 0x28; /* c */
+    int f29 = 0x29; /* c */
+    int f30 = 0x30; /* c */
+    int f31 = 0x31; /* c */
+    int f32 = 0x32; /* c */
+    int f33 = 0x33; /* c */
+    int f34 = 0x34; /* c */
+    int f35 = 0x35; /* c */
+    int f36 = 0x36; /* c */
+    int f37 = 0x37; /* c */
+    int f38 = 0x38; /* c */
+    int f39 = 0x39; /* c */
+    int f40 = 0x40; /* c */
+    int f41 = 0x41; /* c */
+    int f42 = 0x42; /* c */
+    int f43 = 0x43; /* c */
+    int f44 = 0x44; /* c */
+}
@@ -0,0 +1 @@
+0b1010
\ No newline at end of file
@@ -0,0 +1 @@
+'\n'
\ No newline at end of file
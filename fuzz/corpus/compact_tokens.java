@@ -0,0 +1,5 @@
+class A {
+	int a = b[0]; /* x */ c(a);
+  /* multi
+ line */ d::e;
+}
\ No newline at end of file
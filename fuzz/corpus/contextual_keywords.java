@@ -0,0 +1,5 @@
+sealed interface Shape permits Circle {}
+non-sealed class Circle implements Shape {}
+record P(int x) {}
+var y = switch (x) { default -> { yield 1; } };
+int non-sealedX = non - sealed;
@@ -0,0 +1 @@
+@interface @class @1 @_ @a :: ::: @
\ No newline at end of file
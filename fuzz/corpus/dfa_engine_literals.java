@@ -0,0 +1,3 @@
+"a\\" b
+'\'' "open
+x
\ No newline at end of file
@@ -0,0 +1 @@
+1_000 1__ 0x_1 0b12 0xL 1e+ 1e5.5f 1.e3 .5d 1..2 08l 1e_5 1_
\ No newline at end of file
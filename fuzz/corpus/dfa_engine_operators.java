@@ -0,0 +1 @@
+a>>>=b ===c !!d ++++e -->f ->g /=h //x
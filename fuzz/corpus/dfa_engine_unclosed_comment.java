@@ -0,0 +1 @@
+/* unclosed
\ No newline at end of file
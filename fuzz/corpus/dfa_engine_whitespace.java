@@ -0,0 +1,3 @@
+	
+ x 
+ y #  ` \
\ No newline at end of file
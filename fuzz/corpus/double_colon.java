@@ -0,0 +1 @@
+a::b
\ No newline at end of file
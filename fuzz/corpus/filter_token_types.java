@@ -0,0 +1,2 @@
+int a; // x
+/* y */ b = c /* z */+ d;
@@ -0,0 +1 @@
+0.1e-2f
\ No newline at end of file
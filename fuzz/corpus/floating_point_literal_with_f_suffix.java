@@ -0,0 +1 @@
+1f
\ No newline at end of file
@@ -0,0 +1 @@
+.0d
\ No newline at end of file
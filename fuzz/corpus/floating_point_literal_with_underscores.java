@@ -0,0 +1 @@
+3_1.1___________141_592_653
\ No newline at end of file
@@ -0,0 +1 @@
+1_2f
\ No newline at end of file
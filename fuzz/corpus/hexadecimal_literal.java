@@ -0,0 +1 @@
+0x1A3
\ No newline at end of file
@@ -0,0 +1,4 @@
+class A {
+	int a = b[0];
+	c(a);
+}
\ No newline at end of file
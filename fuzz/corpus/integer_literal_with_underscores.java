@@ -0,0 +1 @@
+1_234
\ No newline at end of file
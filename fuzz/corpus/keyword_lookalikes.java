@@ -0,0 +1 @@
+throws thro classes @interface @int >>>= ~=
\ No newline at end of file
@@ -0,0 +1 @@
+($arg1)->{/*Comment*/}
\ No newline at end of file
@@ -0,0 +1,2 @@
+/*xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx**/                                        "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"//xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+                                        '\'' /*/xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
@@ -0,0 +1 @@
+@Override public void test() {}
\ No newline at end of file
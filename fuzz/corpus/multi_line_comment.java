@@ -0,0 +1,2 @@
+a + b /* This is a 
+ multi-line comment */ d
\ No newline at end of file
@@ -0,0 +1 @@
+3_1.1___141_592_653 0b1_______1 017 0xFFFFFFFF 2147483648 12L 1.5f 1e400 08
\ No newline at end of file
@@ -0,0 +1 @@
+/** Docs */ class A { String s = "text"; }
\ No newline at end of file
@@ -0,0 +1,30 @@
+/* comment 0
+   still // inside "
+ */ int x0;
+  String s = "a /* b\";
+
+  char c = '\''; // tail */ /*
+ 1_000 /**/ x >>= 0x1F;
+/* comment 1
+   still // inside "
+ */ int x1;
+  String s = "a /* b\";
+
+  char c = '\''; // tail */ /*
+ 1_000 /**/ x >>= 0x1F;
+/* comment 2
+   still // inside "
+ */ int x2;
+  String s = "a /* b\";
+
+  char c = '\''; // tail */ /*
+ 1_000 /**/ x >>= 0x1F;
+/* comment 3
+   still // inside "
+ */ int x3;
+  String s = "a /* b\";
+
+  char c = '\''; // tail */ /*
+ 1_000 /**/ x >>= 0x1F;
+/* unterminated
+ ...
\ No newline at end of file
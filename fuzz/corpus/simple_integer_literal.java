@@ -0,0 +1 @@
+24
\ No newline at end of file
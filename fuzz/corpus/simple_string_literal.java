@@ -0,0 +1 @@
+"Hello, World!"
\ No newline at end of file
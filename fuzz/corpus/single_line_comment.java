@@ -0,0 +1 @@
+a + b // This is a comment
\ No newline at end of file
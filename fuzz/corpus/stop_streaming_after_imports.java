@@ -0,0 +1,3 @@
+package a.b;
+import c.d;
+class E { int f = 0x1F; }
\ No newline at end of file
@@ -0,0 +1 @@
+"Hello\nWorld\t!"
\ No newline at end of file
@@ -0,0 +1 @@
+"!@#$%^&*()_+-=<>?"
\ No newline at end of file
@@ -0,0 +1,6 @@
+String s = """
+    Hello, "world"
+    \"""
+    """;
+String t = """x"""
+String u = """
@@ -0,0 +1,3 @@
+public class Main {
+    /* comment */ int a = 0x1F;
+}
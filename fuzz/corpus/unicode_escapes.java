@@ -0,0 +1,2 @@
+\u0061b c\uuu00e9 @\u0041 \u0069f x\uD835\uDC00
+a\u00 b\uD835 \u0030
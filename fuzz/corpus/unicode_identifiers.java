@@ -0,0 +1,2 @@
+int größe = 名前 + π2;
+@Überschrift €uro $\u00e9
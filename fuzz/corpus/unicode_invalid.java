@@ -0,0 +1 @@
+a → é ́x  
@@ -0,0 +1 @@
+"Hello
\ No newline at end of file
@@ -0,0 +1,2 @@
+a
+	b
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "lexer_equivalence.h"
+
+/**
+ * libFuzzer entry point: lexes the input with every engine and aborts on the first divergence,
+ * so that the fuzzer saves the input as a crash. Build with `-DSIMPLEJAVALEXER_FUZZ=ON` and Clang.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    std::string input((const char *) data, size);
+    if (auto divergence = findDivergence(input)) {
+        std::cerr << *divergence << "\n";
+        std::abort();
+    }
+    return 0;
+}
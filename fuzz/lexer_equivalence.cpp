@@ -0,0 +1,286 @@
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "lexer_equivalence.h"
+#include "../include/batch_lexer.h"
+#include "../include/identifier_interner.h"
+#include "../include/incremental_lexer.h"
+#include "../include/lexer.h"
+#include "../include/parallel_lexer.h"
+#include "../include/push_lexer.h"
+#include "../include/token_buffer.h"
+
+/**
+ * A set of options every engine that takes `LexOptions` is run with.
+ */
+struct OptionVariant {
+    std::string_view name;  // Suffix of the engine name, e.g. " [untracked]".
+    LexOptions options;     // The options, without an interner.
+    bool interns;           // True if every run gets a fresh `IdentifierInterner`.
+};
+
+/**
+ * A way of lexing a whole source, converted to owned tokens for comparison.
+ */
+struct Engine {
+    std::string_view name;
+    bool takesOptions;  // False if the engine only lexes with the default options.
+    std::function<std::vector<Token>(const std::string &, const LexOptions &)> run;
+};
+
+/**
+ * Converts views to tokens, taking the index of every token from where its lexeme points
+ * rather than from its position, so that a lexeme outside `source` shows up as a wrong index.
+ */
+std::vector<Token> ownViews(const std::string &source, const std::vector<TokenView> &views) {
+    std::vector<Token> tokens;
+    tokens.reserve(views.size());
+    for (const auto &view: views) {
+        Token token(view);
+        token.position.index = (int) (view.lexeme.data() - source.data());
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+std::vector<Token> ownBuffer(const std::string &source, const TokenBuffer &buffer) {
+    std::vector<TokenView> views(buffer.begin(), buffer.end());
+    return ownViews(source, views);
+}
+
+std::vector<Token> pushInChunks(const std::string &source, const LexOptions &options, size_t chunkSize) {
+    PushLexer lexer(options);
+    std::vector<Token> tokens;
+    auto take = [&]() {
+        for (auto &token: lexer.takeTokens()) {
+            tokens.push_back(std::move(token));
+        }
+    };
+    for (size_t i = 0; i < source.size(); i += chunkSize) {
+        lexer.feed(std::string_view(source).substr(i, chunkSize));
+        take();
+    }
+    lexer.finish();
+    take();
+    return tokens;
+}
+
+/**
+ * Rebuilds the source from two parts, so that re-lexing has to repair the tokens around the edit.
+ */
+std::vector<Token> editIncrementally(const std::string &source) {
+    size_t from = source.size() / 3;
+    size_t to = source.size() - from;
+    IncrementalLexer lexer(source.substr(0, from) + source.substr(to));
+    lexer.edit(from, 0, std::string_view(source).substr(from, to - from));
+    return ownBuffer(lexer.getSource(), lexer.tokens());
+}
+
+bool isSameToken(const Token &a, const Token &b) {
+    return a.type == b.type && a.lexeme == b.lexeme &&
+           a.position.index == b.position.index &&
+           a.position.line == b.position.line &&
+           a.position.column == b.position.column &&
+           a.id == b.id && a.numberKind == b.numberKind && a.numberOverflow == b.numberOverflow &&
+           std::bit_cast<uint64_t>(a.number) == std::bit_cast<uint64_t>(b.number);
+}
+
+std::optional<Divergence> compareTokens(std::string engine, const std::vector<Token> &expected,
+                                        const std::vector<Token> &actual) {
+    size_t count = std::max(expected.size(), actual.size());
+    for (size_t i = 0; i < count; i++) {
+        if (i < expected.size() && i < actual.size() && isSameToken(expected[i], actual[i])) continue;
+
+        Divergence divergence{std::move(engine), i, std::nullopt, std::nullopt};
+        if (i < expected.size()) divergence.expected = expected[i];
+        if (i < actual.size()) divergence.actual = actual[i];
+        return divergence;
+    }
+    return std::nullopt;
+}
+
+/**
+ * Checks the line snapshots of `tokenize_view`: the tokens lexed along with them, every line
+ * lexed by `tokenizeRange`, and the range from the middle line to the end.
+ */
+std::optional<Divergence> checkRanges(const std::string &source, const std::string &name, const LexOptions &options,
+                                      const std::vector<Token> &expected) {
+    std::vector<TokenView> views;
+    std::vector<LexerSnapshot> lineSnapshots;
+    tokenize_view(source, views, lineSnapshots, options);
+    if (auto divergence = compareTokens(name + " snapshots", expected, ownViews(source, views))) {
+        return divergence;
+    }
+
+    int lineCount = (int) lineSnapshots.size();
+    auto all = tokenizeRange(source, 1, lineCount + 1, lineSnapshots, options);
+    if (auto divergence = compareTokens(name + " tokenizeRange", expected, ownViews(source, all))) {
+        return divergence;
+    }
+
+    int middle = (lineCount + 1) / 2;
+    if (middle < 1) return std::nullopt;
+    int middleStart = lineSnapshots[middle - 1].position.index;
+    std::vector<Token> overlapping;
+    for (const auto &token: expected) {
+        if (token.position.index + (int) token.lexeme.size() > middleStart) {
+            overlapping.push_back(token);
+        }
+    }
+    auto lower = tokenizeRange(source, middle, lineCount + 1, lineSnapshots, options);
+    return compareTokens(name + " tokenizeRange/" + std::to_string(middle), overlapping, ownViews(source, lower));
+}
+
+const std::vector<Engine> &engines() {
+    static const std::vector<Engine> all = {
+            {"tokenize_view", true, [](const std::string &source, const LexOptions &options) {
+                return ownViews(source, tokenize_view(source, options));
+            }},
+            {"Lexer", true, [](const std::string &source, const LexOptions &options) {
+                std::vector<TokenView> views;
+                Lexer lexer(source, options);
+                while (auto token = lexer.next()) {
+                    views.push_back(*token);
+                }
+                return ownViews(source, views);
+            }},
+            {"PushLexer/1", true, [](const std::string &source, const LexOptions &options) {
+                return pushInChunks(source, options, 1);
+            }},
+            {"PushLexer/7", true, [](const std::string &source, const LexOptions &options) {
+                return pushInChunks(source, options, 7);
+            }},
+            {"DFA tokenize_view", true, [](const std::string &source, LexOptions options) {
+                options.engine = LexerEngine::DFA;
+                return ownViews(source, tokenize_view(source, options));
+            }},
+            {"DFA tokenize", true, [](const std::string &source, LexOptions options) {
+                options.engine = LexerEngine::DFA;
+                return tokenize(source, options);
+            }},
+            {"tokenizeParallel", false, [](const std::string &source, const LexOptions &) {
+                return ownViews(source, tokenizeParallel(source, {.segmentSize = 16, .checkpointInterval = 4}));
+            }},
+            {"tokenizeCompact", false, [](const std::string &source, const LexOptions &) {
+                return ownBuffer(source, tokenizeCompact(source));
+            }},
+            {"tokenizeAll [line cache]", false, [](const std::string &source, const LexOptions &) {
+                // One worker lexes the source twice, so the second copy reuses every cached line.
+                static ThreadPool pool(1);
+                std::vector<std::string_view> sources = {source, source};
+                return ownViews(source, tokenizeAll(sources, {.pool = &pool, .lineCacheSize = 64})[1]);
+            }},
+            {"IncrementalLexer", false, [](const std::string &source, const LexOptions &) {
+                return editIncrementally(source);
+            }},
+    };
+    return all;
+}
+
+const std::vector<OptionVariant> &optionVariants() {
+    static const std::vector<OptionVariant> all = {
+            {"", {}, false},
+            {" [untracked]", {.trackPositions = false}, false},
+            {" [no whitespace or comments]",
+             {.emitTypes = all_token_types & ~tokenTypeBit(TokenType::WHITESPACE) & ~comment_token_types}, false},
+            {" [numbers and ids]", {.parseNumbers = true}, true},
+    };
+    return all;
+}
+
+std::optional<Divergence> findDivergence(const std::string &input) {
+    for (const auto &variant: optionVariants()) {
+        // Every run gets its own interner, so that ids are assigned from 0 in source order each time.
+        auto withInterner = [&](std::unique_ptr<IdentifierInterner> &interner) {
+            LexOptions options = variant.options;
+            if (variant.interns) {
+                interner = std::make_unique<IdentifierInterner>();
+                options.interner = interner.get();
+            }
+            return options;
+        };
+
+        std::unique_ptr<IdentifierInterner> referenceInterner;
+        std::vector<Token> expected = tokenize(input, withInterner(referenceInterner));
+
+        for (const auto &engine: engines()) {
+            bool isDefault = variant.name.empty();
+            if (!engine.takesOptions && !isDefault) continue;
+
+            std::unique_ptr<IdentifierInterner> interner;
+            std::string name = std::string(engine.name) + std::string(variant.name);
+            if (auto divergence = compareTokens(name, expected, engine.run(input, withInterner(interner)))) {
+                return divergence;
+            }
+        }
+
+        std::unique_ptr<IdentifierInterner> rangeInterner;
+        std::string name = "tokenize_view" + std::string(variant.name);
+        if (auto divergence = checkRanges(input, name, withInterner(rangeInterner), expected)) {
+            return divergence;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * Writes a lexeme with control characters and non-ASCII bytes escaped, so that divergences
+ * found by the fuzzer can be read and pasted into a test.
+ */
+void writeEscaped(std::ostream &strm, std::string_view text) {
+    static const char *hex = "0123456789ABCDEF";
+    for (char c: text) {
+        auto byte = (unsigned char) c;
+        switch (c) {
+            case '\n':
+                strm << "\\n";
+                break;
+            case '\r':
+                strm << "\\r";
+                break;
+            case '\t':
+                strm << "\\t";
+                break;
+            case '\\':
+                strm << "\\\\";
+                break;
+            case '\'':
+                strm << "\\'";
+                break;
+            default:
+                if (byte < 0x20 || byte >= 0x7F) {
+                    strm << "\\x" << hex[byte >> 4] << hex[byte & 0xF];
+                } else {
+                    strm << c;
+                }
+        }
+    }
+}
+
+void writeToken(std::ostream &strm, const std::optional<Token> &token) {
+    if (!token) {
+        strm << "no token";
+        return;
+    }
+    strm << "Token{Type: " << getTokenTypeName(token->type) << ", Index: " << token->position.index
+         << ", Position: " << token->position.line << ":" << token->position.column << ", Lexeme: '";
+    writeEscaped(strm, token->lexeme);
+    strm << "'";
+    if (token->id != no_identifier_id) strm << ", Id: " << token->id;
+    if (token->numberKind != NumberKind::NONE) {
+        strm << ", Number: " << (int) token->numberKind << "/" << std::bit_cast<uint64_t>(token->number)
+             << (token->numberOverflow ? " (overflow)" : "");
+    }
+    strm << "}";
+}
+
+std::ostream &operator<<(std::ostream &strm, const Divergence &divergence) {
+    strm << divergence.engine << " diverges at token " << divergence.index << ": expected ";
+    writeToken(strm, divergence.expected);
+    strm << ", got ";
+    writeToken(strm, divergence.actual);
+    return strm;
+}
@@ -0,0 +1,39 @@
+#ifndef SIMPLEJAVALEXER_LEXER_EQUIVALENCE_H
+#define SIMPLEJAVALEXER_LEXER_EQUIVALENCE_H
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include "../include/token.h"
+
+/**
+ * The first token on which an engine disagrees with the reference `tokenize`.
+ */
+struct Divergence {
+    std::string engine;             // The engine and option variant that diverged, e.g. "PushLexer/1 [untracked]".
+    size_t index;                   // Index of the first differing token.
+    std::optional<Token> expected;  // The token of `tokenize`; empty if the engine produced too many tokens.
+    std::optional<Token> actual;    // The token of the engine; empty if it produced too few tokens.
+
+    friend std::ostream &operator<<(std::ostream &strm, const Divergence &divergence);
+};
+
+/**
+ * Runs every way of lexing a whole source on the same input and compares the tokens to those of
+ * `tokenize` with the state machine: `tokenize_view`, the pull and push lexers (with chunks of 1
+ * and 7 bytes), the DFA engine, line snapshots and `tokenizeRange`, the parallel lexer (with tiny
+ * segments, so that seams are repaired even in small inputs), the batch lexer with a line cache,
+ * the compact buffer and the incremental lexer. The engines that take `LexOptions` are run once for
+ * each of a few option variants (untracked positions, filtered token types, parsed numbers and
+ * interned identifiers).
+ *
+ * Tokens are compared field by field, including ids and number values; the position index of a
+ * view is taken from where its lexeme actually points, so views outside the source are caught too.
+ *
+ * @param input - Any bytes; they need not be valid Java.
+ * @return The first divergence, or `std::nullopt` if every engine produced the reference tokens.
+ */
+std::optional<Divergence> findDivergence(const std::string &input);
+
+#endif //SIMPLEJAVALEXER_LEXER_EQUIVALENCE_H
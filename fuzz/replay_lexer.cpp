@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "lexer_equivalence.h"
+
+/**
+ * Collects the files to replay: regular files as given, and every file below a directory, sorted.
+ */
+void collectInputs(const std::filesystem::path &path, std::vector<std::filesystem::path> &inputs) {
+    if (!std::filesystem::is_directory(path)) {
+        inputs.push_back(path);
+        return;
+    }
+    std::vector<std::filesystem::path> found;
+    for (const auto &entry: std::filesystem::recursive_directory_iterator(path)) {
+        if (entry.is_regular_file()) found.push_back(entry.path());
+    }
+    std::sort(found.begin(), found.end());
+    inputs.insert(inputs.end(), found.begin(), found.end());
+}
+
+/**
+ * Runs every engine on the given inputs and reports the first divergent token of each input.
+ *
+ * Usage: `SimpleJavaLexerReplay [file or directory]...`; without arguments, the input is read
+ * from stdin. Exits with 1 if any input diverged, e.g. for AFL with `AFL_CRASH_EXITCODE=1`.
+ */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::string input(std::istreambuf_iterator<char>(std::cin), {});
+        if (auto divergence = findDivergence(input)) {
+            std::cerr << "<stdin>: " << *divergence << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<std::filesystem::path> inputs;
+    for (int i = 1; i < argc; i++) {
+        collectInputs(argv[i], inputs);
+    }
+
+    size_t divergent = 0;
+    for (const auto &path: inputs) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << path.string() << ": cannot be read\n";
+            divergent++;
+            continue;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        if (auto divergence = findDivergence(buffer.str())) {
+            std::cerr << path.string() << ": " << *divergence << "\n";
+            divergent++;
+        }
+    }
+    std::cout << inputs.size() << " inputs replayed, " << divergent << " divergent.\n";
+    return divergent == 0 ? 0 : 1;
+}
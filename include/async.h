@@ -0,0 +1,523 @@
+#ifndef SIMPLEJAVALEXER_ASYNC_H
+#define SIMPLEJAVALEXER_ASYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * The C++20 coroutine building blocks of the pipeline (see `pipeline.h`): an executor, tasks,
+ * bounded channels and asynchronous file reads.
+ *
+ * A suspended coroutine holds no thread: a coroutine waiting for a read, for room in a channel
+ * or for a value from it is resumed on an executor thread once it can continue, so a few threads
+ * keep many files in flight.
+ */
+
+/**
+ * A fixed set of threads that resume coroutines in the order they are posted.
+ */
+class Executor {
+public:
+    /**
+     * Starts the threads.
+     * @param threads - Number of threads; 0 uses the number of hardware threads.
+     */
+    explicit Executor(unsigned threads = 0);
+
+    Executor(const Executor &) = delete;
+
+    Executor &operator=(const Executor &) = delete;
+
+    /**
+     * Stops the threads once the posted coroutines have run. Suspended coroutines are not resumed.
+     */
+    ~Executor();
+
+    /**
+     * Resumes a coroutine on one of the threads.
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * Returns an awaitable that moves the awaiting coroutine onto one of the threads.
+     */
+    auto schedule() {
+        struct Awaiter {
+            Executor *executor;
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const {
+                executor->post(handle);
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+    /**
+     * Returns the number of threads.
+     */
+    [[nodiscard]] unsigned size() const {
+        return (unsigned) workers.size();
+    }
+
+private:
+    std::mutex mutex;                             // Guards the fields below.
+    std::condition_variable wakeUp;               // Signals that a coroutine was posted or the executor stops.
+    std::deque<std::coroutine_handle<>> ready;    // Coroutines to resume, oldest first.
+    bool stopping = false;                        // True once the executor is being destroyed.
+    std::vector<std::thread> workers;
+
+    void work();
+};
+
+/**
+ * A coroutine that produces no value and starts when it is awaited.
+ *
+ * An exception thrown by the coroutine is rethrown to the awaiting coroutine.
+ */
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation = std::noop_coroutine();  // Resumed when the task finishes.
+        std::exception_ptr error;                                     // Exception thrown by the task, if any.
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct Awaiter {
+                [[nodiscard]] bool await_ready() const noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+                    return handle.promise().continuation;
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            error = std::current_exception();
+        }
+    };
+
+    Task(Task &&other) noexcept: handle(std::exchange(other.handle, {})) {}
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * Runs the task to completion, then resumes the awaiting coroutine.
+     */
+    auto operator co_await() const noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            void await_resume() const {
+                if (handle.promise().error) {
+                    std::rethrow_exception(handle.promise().error);
+                }
+            }
+        };
+        return Awaiter{handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+};
+
+/**
+ * Tasks running concurrently on an executor, which a thread outside of it can wait for.
+ */
+class TaskGroup {
+public:
+    /**
+     * Creates an empty group.
+     * @param executor - The executor that runs the tasks.
+     */
+    explicit TaskGroup(Executor &executor) : executor(executor) {}
+
+    TaskGroup(const TaskGroup &) = delete;
+
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    /**
+     * Starts a task on the executor.
+     */
+    void spawn(Task task);
+
+    /**
+     * Blocks until every task has finished.
+     * @throws The first exception thrown by a task.
+     */
+    void wait();
+
+    /**
+     * Records that a task finished; called by the coroutine running it, after destroying it.
+     */
+    void finish(std::exception_ptr taskError);
+
+private:
+    Executor &executor;
+    std::mutex mutex;               // Guards the fields below.
+    std::condition_variable done;   // Signals that the last task finished.
+    size_t running = 0;             // Tasks that have not finished.
+    std::exception_ptr error;       // The first exception thrown by a task.
+};
+
+/**
+ * A bounded, thread-safe queue between coroutines.
+ *
+ * `push` suspends while the channel is full, which slows producers down to the pace of the
+ * consumers, and `pop` suspends while it is empty. Once the channel is closed, pushes fail and
+ * pops drain the remaining values.
+ */
+template<typename T>
+class Channel {
+public:
+    /**
+     * The awaitable of `push`, which yields false if the channel was closed and the value dropped.
+     */
+    struct PushAwaiter {
+        Channel *channel;
+        T value;
+        std::coroutine_handle<> handle;
+        bool pushed = false;
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            return channel->suspendPush(*this);
+        }
+
+        [[nodiscard]] bool await_resume() const noexcept {
+            return pushed;
+        }
+    };
+
+    /**
+     * The awaitable of `pop`, which yields `std::nullopt` once the channel is closed and empty.
+     */
+    struct PopAwaiter {
+        Channel *channel;
+        std::optional<T> value;
+        std::coroutine_handle<> handle;
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            return channel->suspendPop(*this);
+        }
+
+        std::optional<T> await_resume() {
+            return std::move(value);
+        }
+    };
+
+    /**
+     * Creates an empty channel.
+     * @param capacity - Number of values that can wait in the channel; at least 1.
+     * @param executor - The executor that resumes waiting coroutines.
+     */
+    Channel(size_t capacity, Executor &executor) : capacity(capacity > 0 ? capacity : 1), executor(executor) {}
+
+    Channel(const Channel &) = delete;
+
+    Channel &operator=(const Channel &) = delete;
+
+    /**
+     * Returns an awaitable that adds a value, suspending while the channel is full.
+     */
+    PushAwaiter push(T value) {
+        return {this, std::move(value)};
+    }
+
+    /**
+     * Returns an awaitable that takes the oldest value, suspending while the channel is empty.
+     */
+    PopAwaiter pop() {
+        return {this};
+    }
+
+    /**
+     * Closes the channel, failing the pushes that wait and waking the pops that wait.
+     */
+    void close() {
+        std::lock_guard lock(mutex);
+        closed = true;
+        for (PushAwaiter *waiter: pushers) {
+            executor.post(waiter->handle);
+        }
+        for (PopAwaiter *waiter: poppers) {
+            executor.post(waiter->handle);
+        }
+        pushers.clear();
+        poppers.clear();
+    }
+
+private:
+    size_t capacity;
+    Executor &executor;
+    std::mutex mutex;                  // Guards the fields below.
+    std::deque<T> values;              // Values waiting for a consumer, oldest first.
+    std::deque<PushAwaiter *> pushers; // Producers waiting for room, oldest first.
+    std::deque<PopAwaiter *> poppers;  // Consumers waiting for a value, oldest first.
+    bool closed = false;
+
+    // An awaiter is never touched after its coroutine is posted, since that may resume it at once.
+
+    /**
+     * Adds the value of a push, or queues the pushing coroutine.
+     * @return true if the coroutine must suspend.
+     */
+    bool suspendPush(PushAwaiter &awaiter) {
+        std::lock_guard lock(mutex);
+        if (closed) {
+            return false;
+        }
+        awaiter.pushed = true;
+        if (!poppers.empty()) {
+            PopAwaiter *consumer = poppers.front();
+            poppers.pop_front();
+            consumer->value = std::move(awaiter.value);
+            executor.post(consumer->handle);
+            return false;
+        }
+        if (values.size() < capacity) {
+            values.push_back(std::move(awaiter.value));
+            return false;
+        }
+        awaiter.pushed = false;
+        pushers.push_back(&awaiter);
+        return true;
+    }
+
+    /**
+     * Takes a value for a pop, or queues the popping coroutine.
+     * @return true if the coroutine must suspend.
+     */
+    bool suspendPop(PopAwaiter &awaiter) {
+        std::lock_guard lock(mutex);
+        if (!values.empty()) {
+            awaiter.value = std::move(values.front());
+            values.pop_front();
+            if (!pushers.empty()) {
+                PushAwaiter *producer = pushers.front();
+                pushers.pop_front();
+                values.push_back(std::move(producer->value));
+                producer->pushed = true;
+                executor.post(producer->handle);
+            }
+            return false;
+        }
+        if (closed) {
+            return false;
+        }
+        poppers.push_back(&awaiter);
+        return true;
+    }
+};
+
+/**
+ * A file opened for asynchronous reads (see `FileReader`).
+ */
+class AsyncFile {
+public:
+    /**
+     * Opens a file for reading.
+     * @param path - The path of the file.
+     * @throws std::system_error if the file cannot be opened.
+     */
+    explicit AsyncFile(const std::string &path);
+
+    AsyncFile(const AsyncFile &) = delete;
+
+    AsyncFile &operator=(const AsyncFile &) = delete;
+
+    ~AsyncFile();
+
+private:
+    friend class FileReader;
+
+    int fd = -1;                  // The descriptor, where POSIX I/O is available.
+    void *stream = nullptr;       // The `FILE` of the file elsewhere.
+};
+
+/**
+ * Reads files asynchronously: with io_uring where the kernel headers and the running kernel
+ * support it, and otherwise on I/O threads doing blocking reads.
+ *
+ * A read starts when it is constructed and is awaited later, so a coroutine can lex one chunk
+ * while the next one is read. The reader must outlive its reads.
+ */
+class FileReader {
+public:
+    /**
+     * A read of one block of a file, which must not be moved once started.
+     */
+    class Read {
+    public:
+        /**
+         * Starts the read.
+         * @param reader - The reader doing the read.
+         * @param file - The file to read.
+         * @param buffer - Where to store the bytes; must stay valid until the read completes.
+         * @param size - The maximum number of bytes to read.
+         * @param offset - The offset in the file to read from.
+         */
+        Read(FileReader &reader, const AsyncFile &file, char *buffer, size_t size, uint64_t offset);
+
+        Read(const Read &) = delete;
+
+        Read &operator=(const Read &) = delete;
+
+        /**
+         * Blocks until the read completes, if it was never awaited.
+         */
+        ~Read();
+
+        /**
+         * Waits for the read; awaiting yields the number of bytes read, 0 at the end of the file.
+         * @throws std::system_error if the read failed.
+         */
+        auto operator co_await() noexcept {
+            struct Awaiter {
+                Read *read;
+
+                [[nodiscard]] bool await_ready() const noexcept {
+                    return read->state.load(std::memory_order_acquire) == completed;
+                }
+
+                bool await_suspend(std::coroutine_handle<> awaiting) const {
+                    return read->suspend(awaiting);
+                }
+
+                [[nodiscard]] size_t await_resume() const {
+                    return read->bytesRead();
+                }
+            };
+            return Awaiter{this};
+        }
+
+    private:
+        friend class FileReader;
+
+        static constexpr int started = 0;    // Neither completed nor awaited.
+        static constexpr int awaited = 1;    // A coroutine waits for the completion.
+        static constexpr int completed = 2;  // `result` is set.
+
+        FileReader &reader;
+        const AsyncFile &file;
+        char *buffer;
+        size_t size;
+        uint64_t offset;
+        long long result = 0;                 // Bytes read, or the negated error number.
+        std::coroutine_handle<> handle;        // The awaiting coroutine, once `state` is `awaited`.
+        std::atomic<int> state{started};
+
+        bool suspend(std::coroutine_handle<> awaiting);
+
+        size_t bytesRead() const;
+
+        void complete(long long bytes);
+    };
+
+    /**
+     * Sets up the reader.
+     * @param executor - The executor that resumes the coroutines waiting for reads.
+     * @param depth - Maximum number of reads in flight at the same time.
+     * @param useIoUring - False to always use I/O threads.
+     */
+    FileReader(Executor &executor, unsigned depth, bool useIoUring = true);
+
+    FileReader(const FileReader &) = delete;
+
+    FileReader &operator=(const FileReader &) = delete;
+
+    /**
+     * Stops the reader; every read must have completed.
+     */
+    ~FileReader();
+
+    /**
+     * Returns true if reads go through io_uring.
+     */
+    [[nodiscard]] bool usesIoUring() const {
+        return ring != nullptr;
+    }
+
+private:
+    struct Ring;
+
+    Executor &executor;
+    Ring *ring = nullptr;                 // The io_uring, if used.
+    std::mutex mutex;                     // Guards the fields below.
+    std::condition_variable wakeUp;       // Signals I/O threads that a read was queued or the reader stops.
+    std::deque<Read *> queued;            // Reads waiting for an I/O thread, oldest first.
+    bool stopping = false;
+    std::vector<std::thread> threads;     // The I/O threads, or the thread reaping io_uring completions.
+
+    void submit(Read &read);
+
+    void readOnThread();
+
+    void reapCompletions();
+};
+
+#endif //SIMPLEJAVALEXER_ASYNC_H
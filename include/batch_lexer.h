@@ -0,0 +1,44 @@
+#ifndef SIMPLEJAVALEXER_BATCH_LEXER_H
+#define SIMPLEJAVALEXER_BATCH_LEXER_H
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "thread_pool.h"
+
+class IdentifierInterner;
+
+/**
+ * Options for `tokenizeAll`.
+ */
+struct BatchOptions {
+    ThreadPool *pool = nullptr;  // Pool to run on; nullptr uses a shared pool with one worker per hardware thread.
+    IdentifierInterner *interner = nullptr;  // Table shared by all sources for identifier IDs; nullptr for none.
+    size_t lineCacheSize = 0;    // Distinct lines whose tokens each worker keeps for reuse; 0 lexes every line.
+};
+
+/**
+ * Tokenizes many independent Java sources in parallel.
+ *
+ * Sources are started largest first and balanced over the pool's workers with work stealing,
+ * so a few huge generated files do not stall the batch. Each worker lexes into a reusable
+ * scratch buffer and copies the result into an exactly-sized vector, so the output vectors
+ * never reallocate while they grow.
+ *
+ * With a line cache, which pays off for generated code with many identical lines, each worker
+ * remembers the tokens of up to `lineCacheSize` distinct lines. Every line that starts outside
+ * a comment or text block is looked up by its XXH64 hash and its bytes, and on a hit its tokens
+ * are copied with shifted lexemes and positions instead of being lexed again. Lines are only
+ * cached when they also end outside a comment or text block, so the tokens are exactly those
+ * of lexing the whole source. The cache lives for one call and may hold lines of any source.
+ *
+ * @param sources - The Java sources; each must outlive its tokens.
+ * @param options - How to run the batch.
+ * @return For each source, in the same order, the tokens `tokenize_view` would produce.
+ */
+std::vector<std::vector<TokenView>> tokenizeAll(std::span<const std::string_view> sources,
+                                                const BatchOptions &options = {});
+
+#endif //SIMPLEJAVALEXER_BATCH_LEXER_H
@@ -0,0 +1,105 @@
+#ifndef SIMPLEJAVALEXER_CHAR_CLASS_H
+#define SIMPLEJAVALEXER_CHAR_CLASS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Bit flags describing which lexical classes a single byte belongs to.
+ * A byte may belong to several classes (e.g., '1' is a digit and an identifier part).
+ */
+enum CharClass : uint8_t {
+    CHAR_IDENTIFIER_START = 1 << 0, // [a-zA-Z_$]
+    CHAR_IDENTIFIER_PART = 1 << 1,  // [a-zA-Z0-9_$]
+    CHAR_WHITESPACE = 1 << 2,       // Spaces, tabs, newlines, vertical tabs and form feeds.
+    CHAR_OPERATOR_START = 1 << 3,   // Characters that may start a Java operator.
+    CHAR_DIGIT = 1 << 4,            // [0-9]
+    CHAR_HEX_DIGIT = 1 << 5,        // [0-9a-fA-F]
+    CHAR_BINARY_DIGIT = 1 << 6,     // [01]
+    CHAR_UNICODE_START = 1 << 7,    // Bytes >= 0x80 and '\', which may begin a UTF-8 character or a `\u` escape.
+};
+
+/**
+ * Characters that could initiate a Java operator.
+ */
+inline constexpr std::string_view java_operators_starter = "=!<>+-*/&~|%^";
+
+/**
+ * Builds the 256-entry character class table at compile time.
+ * @return A table mapping each byte value to its `CharClass` flags.
+ */
+constexpr std::array<uint8_t, 256> buildCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        bool isLower = c >= 'a' && c <= 'z';
+        bool isUpper = c >= 'A' && c <= 'Z';
+        bool isDigit = c >= '0' && c <= '9';
+        uint8_t flags = 0;
+        if (isLower || isUpper || c == '_' || c == '$') {
+            flags |= CHAR_IDENTIFIER_START | CHAR_IDENTIFIER_PART;
+        }
+        if (isDigit) {
+            flags |= CHAR_IDENTIFIER_PART | CHAR_DIGIT | CHAR_HEX_DIGIT;
+        }
+        if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+            flags |= CHAR_HEX_DIGIT;
+        }
+        if (c == '0' || c == '1') {
+            flags |= CHAR_BINARY_DIGIT;
+        }
+        if (c >= 0x80 || c == '\\') {
+            flags |= CHAR_UNICODE_START;
+        }
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r') {
+            flags |= CHAR_WHITESPACE;
+        }
+        table[c] = flags;
+    }
+    for (char c: java_operators_starter) {
+        table[(unsigned char) c] |= CHAR_OPERATOR_START;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> char_class_table = buildCharClassTable();
+
+/**
+ * Checks if a character belongs to any of the given classes.
+ * @param c - The character to check.
+ * @param classes - A combination of `CharClass` flags.
+ * @return true if the character has at least one of the flags; false otherwise.
+ */
+constexpr bool hasCharClass(char c, uint8_t classes) {
+    return (char_class_table[(unsigned char) c] & classes) != 0;
+}
+
+/**
+ * Checks if a character can start a Java identifier (letters, '_' or '$').
+ */
+constexpr bool isIdentifierStart(char c) {
+    return hasCharClass(c, CHAR_IDENTIFIER_START);
+}
+
+/**
+ * Checks if a character can be part of a Java identifier (letters, digits, '_' or '$').
+ */
+constexpr bool isIdentifierLetter(char c) {
+    return hasCharClass(c, CHAR_IDENTIFIER_PART);
+}
+
+/**
+ * Checks if a character is whitespace (spaces, tabs, newlines, etc.).
+ */
+constexpr bool isWhitespace(char c) {
+    return hasCharClass(c, CHAR_WHITESPACE);
+}
+
+/**
+ * Checks if a character could initiate a Java operator.
+ */
+constexpr bool isOperatorStart(char c) {
+    return hasCharClass(c, CHAR_OPERATOR_START);
+}
+
+#endif //SIMPLEJAVALEXER_CHAR_CLASS_H
@@ -0,0 +1,20 @@
+#ifndef SIMPLEJAVALEXER_CONTENT_HASH_H
+#define SIMPLEJAVALEXER_CONTENT_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Hashes the contents of a whole source with the XXH64 algorithm.
+ *
+ * XXH64 processes 32 bytes per round in four independent lanes, so it runs at several
+ * gigabytes per second and costs a small fraction of lexing the same bytes. The result is
+ * identical to the reference implementation, so hashes can be compared with other tools.
+ *
+ * @param data - The bytes to hash.
+ * @param seed - The seed of the hash.
+ * @return The 64-bit hash value.
+ */
+uint64_t contentHash(std::string_view data, uint64_t seed = 0);
+
+#endif //SIMPLEJAVALEXER_CONTENT_HASH_H
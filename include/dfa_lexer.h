@@ -0,0 +1,40 @@
+#ifndef SIMPLEJAVALEXER_DFA_LEXER_H
+#define SIMPLEJAVALEXER_DFA_LEXER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "lexer.h"
+
+/**
+ * Tokenizes the given Java source code with a table-driven DFA instead of the state machine of `Lexer`.
+ *
+ * The DFA is generated at compile time from the keyword, operator and symbol tables of
+ * `token_matcher.h` and the character classes of `char_class.h`. Bytes are first mapped to one of
+ * a few dozen equivalence classes (bytes that no state tells apart share a class), so the whole
+ * transition table is a few kilobytes and the inner loop is one table lookup per byte. Every token
+ * is the longest match of the DFA, backing off to the last accepting state where the state machine
+ * looks ahead (underscores inside numbers and exponents); keywords are told apart from identifiers
+ * by the same perfect hash `getTokenType` uses, once a word has been matched.
+ *
+ * The tokens are the same as those of `tokenize_view`, including its handling of unterminated
+ * literals, comments and merged whitespace. Selected with `LexOptions::engine`.
+ *
+ * @param source - The Java source code; must outlive the tokens.
+ * @param tokens - The vector that receives the tokens; it is cleared but keeps its capacity.
+ * @param options - What to compute for every token, and which token types to emit; `engine` is ignored.
+ */
+void tokenizeDfa(std::string_view source, std::vector<TokenView> &tokens, const LexOptions &options = {});
+
+/**
+ * Returns the number of states of the generated DFA, including the dead state.
+ */
+size_t dfaStateCount();
+
+/**
+ * Returns the number of byte equivalence classes of the generated DFA.
+ */
+size_t dfaByteClassCount();
+
+#endif //SIMPLEJAVALEXER_DFA_LEXER_H
@@ -0,0 +1,88 @@
+#ifndef SIMPLEJAVALEXER_IDENTIFIER_INTERNER_H
+#define SIMPLEJAVALEXER_IDENTIFIER_INTERNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "lexeme_arena.h"
+
+/**
+ * A thread-safe table that assigns every distinct identifier a dense `uint32_t` ID.
+ *
+ * When attached to a lexer (see `LexOptions::interner`), every `IDENTIFIER` token, and every
+ * `CONTEXTUAL_KEYWORD` except `non-sealed`, gets the ID of its lexeme in `TokenView::id`, so
+ * later stages compare and hash integers instead of strings. One interner can be shared by all
+ * the files of a batch: equal identifiers get equal IDs in every file, and IDs are assigned in
+ * the order identifiers are first seen, from 0.
+ *
+ * The table is split into shards by the hash of the identifier, each with its own lock and its
+ * own arena for the copies of the names, so threads interning different identifiers rarely
+ * contend. Looking up a known identifier only takes a shared lock of its shard.
+ */
+class IdentifierInterner {
+public:
+    /**
+     * Creates an empty table.
+     * @param shardCount - The number of independently locked shards; at least 1.
+     */
+    explicit IdentifierInterner(size_t shardCount = 64);
+
+    IdentifierInterner(const IdentifierInterner &) = delete;
+
+    IdentifierInterner &operator=(const IdentifierInterner &) = delete;
+
+    /**
+     * Returns the ID of an identifier, assigning the next free ID if it is new.
+     * @param name - The identifier; it is copied, so it does not have to outlive the table.
+     * @return The ID of `name`.
+     */
+    uint32_t intern(std::string_view name);
+
+    /**
+     * Returns the identifier with the given ID.
+     * @param id - An ID returned by `intern`.
+     * @return The identifier, valid for the lifetime of the table.
+     */
+    [[nodiscard]] std::string_view name(uint32_t id) const;
+
+    /**
+     * Returns the number of distinct identifiers, which is also the next ID to be assigned.
+     */
+    [[nodiscard]] size_t size() const;
+
+private:
+    /**
+     * An identifier together with its hash, so that the hash is computed only once.
+     */
+    struct Key {
+        std::string_view name;
+        size_t hash;
+
+        bool operator==(const Key &other) const {
+            return hash == other.hash && name == other.name;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return key.hash;
+        }
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;                  // Guards `ids` and `names`.
+        std::unordered_map<Key, uint32_t, KeyHash> ids;   // IDs by identifier.
+        LexemeArena names{16 * 1024};                     // Copies of the identifiers of this shard.
+    };
+
+    size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+    mutable std::shared_mutex namesMutex;  // Guards `names`.
+    std::vector<std::string_view> names;   // Identifiers by ID, pointing into the shard arenas.
+};
+
+#endif //SIMPLEJAVALEXER_IDENTIFIER_INTERNER_H
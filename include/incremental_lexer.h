@@ -0,0 +1,71 @@
+#ifndef SIMPLEJAVALEXER_INCREMENTAL_LEXER_H
+#define SIMPLEJAVALEXER_INCREMENTAL_LEXER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "token_buffer.h"
+
+/**
+ * The tokens changed by `IncrementalLexer::edit`.
+ */
+struct TokenEdit {
+    size_t first;     // Index of the first changed token.
+    size_t removed;   // Number of tokens removed at `first`.
+    size_t inserted;  // Number of tokens inserted at `first` in their place.
+};
+
+/**
+ * Keeps the tokens of a source up to date while the source is being edited (e.g., in an editor).
+ *
+ * An edit re-lexes the source from the start of the token before the edit, which is a point where
+ * the lexer is known to be in `STATE_NONE`. Lexing stops as soon as a new token starts at the shifted
+ * offset of an old token after the edit, with the same previous token type: from there on the lexer
+ * behaves exactly as it did before, so the remaining old tokens are kept and only shifted. An edit
+ * therefore costs the re-lexed tokens plus a shift of plain offsets, instead of a full `tokenize`.
+ *
+ * The lexer owns its source and is neither copyable nor movable, since its tokens point into it.
+ */
+class IncrementalLexer {
+public:
+    /**
+     * Tokenizes the initial source.
+     * @param source - The Java source code.
+     */
+    explicit IncrementalLexer(std::string source);
+
+    IncrementalLexer(const IncrementalLexer &) = delete;
+
+    IncrementalLexer &operator=(const IncrementalLexer &) = delete;
+
+    /**
+     * Replaces a part of the source and updates the tokens.
+     * @param offset - Offset of the first replaced character.
+     * @param removed - Number of characters to remove at `offset`.
+     * @param inserted - The text to insert at `offset`.
+     * @return The range of tokens that changed; tokens after it only moved.
+     */
+    TokenEdit edit(size_t offset, size_t removed, std::string_view inserted);
+
+    /**
+     * Returns the current source.
+     */
+    [[nodiscard]] const std::string &getSource() const {
+        return source;
+    }
+
+    /**
+     * Returns the tokens of the current source, identical to those `tokenize` would produce.
+     */
+    [[nodiscard]] const TokenBuffer &tokens() const {
+        return buffer;
+    }
+
+private:
+    std::string source;  // The current source code.
+    TokenBuffer buffer;  // The tokens of `source`.
+
+    [[nodiscard]] size_t restartToken(size_t offset) const;
+};
+
+#endif //SIMPLEJAVALEXER_INCREMENTAL_LEXER_H
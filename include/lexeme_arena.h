@@ -0,0 +1,80 @@
+#ifndef SIMPLEJAVALEXER_LEXEME_ARENA_H
+#define SIMPLEJAVALEXER_LEXEME_ARENA_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * A bump-pointer arena that owns copies of lexemes.
+ *
+ * Copies are packed one after another into large blocks, so copying a lexeme is a `memcpy`
+ * and a pointer increment, and the whole arena is freed at once when it is destroyed. Copies
+ * never move: views returned by `copy` stay valid until the arena is destroyed or cleared,
+ * even if the arena itself is moved.
+ */
+class LexemeArena {
+public:
+    /**
+     * Creates an empty arena; no memory is allocated until the first copy.
+     * @param blockSize - The minimum size of the blocks the arena allocates.
+     */
+    explicit LexemeArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+    LexemeArena(LexemeArena &&other) noexcept;
+
+    LexemeArena &operator=(LexemeArena &&other) noexcept;
+
+    LexemeArena(const LexemeArena &) = delete;
+
+    LexemeArena &operator=(const LexemeArena &) = delete;
+
+    /**
+     * Copies text into the arena.
+     * @param text - The text to copy.
+     * @return A view of the copy, valid for the lifetime of the arena.
+     */
+    std::string_view copy(std::string_view text) {
+        if (text.size() > remaining) {
+            grow(text.size());
+        }
+        char *start = cursor;
+        std::memcpy(start, text.data(), text.size());
+        cursor += text.size();
+        remaining -= text.size();
+        return {start, text.size()};
+    }
+
+    /**
+     * Makes sure the next `bytes` bytes of copies fit into a single block,
+     * starting a block of exactly that size if they do not fit into the current one.
+     */
+    void reserve(size_t bytes);
+
+    /**
+     * Frees every block, invalidating all copies.
+     */
+    void clear();
+
+    /**
+     * Returns the number of bytes allocated by the arena.
+     */
+    [[nodiscard]] size_t memoryUsage() const {
+        return allocated;
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;  // Every block allocated so far.
+    char *cursor = nullptr;                       // Next free byte of the last block.
+    size_t remaining = 0;                         // Free bytes after `cursor`.
+    size_t allocated = 0;                         // Total size of `blocks`.
+    size_t blockSize;                             // Minimum size of a new block.
+
+    void grow(size_t minimum);
+
+    void addBlock(size_t size);
+};
+
+#endif //SIMPLEJAVALEXER_LEXEME_ARENA_H
@@ -6,13 +6,460 @@
 #define SIMPLEJAVALEXER_LEXER_H
 
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
 #include "token.h"
+#include "source_file.h"
+#include "lexeme_arena.h"
+
+class IdentifierInterner;
+
+/**
+ * Enum representing the possible states of the tokenizer during lexical analysis.
+ */
+enum TokenizerState {
+    STATE_NONE,            // No specific state; beginning or resetting tokenization.
+    STATE_WORD,            // Reading an identifier or keyword.
+    STATE_LINE_COMMENT,    // Inside a single-line comment.
+    STATE_BLOCK_COMMENT,   // Inside a multi-line block comment.
+    STATE_LITERAL_STRING,  // Inside a string literal.
+    STATE_TEXT_BLOCK,      // Inside a multi-line text block.
+    STATE_LITERAL_CHAR,    // Inside a character literal.
+    STATE_OPERATORS,       // Parsing operators.
+    STATE_NUMBERS,         // Parsing numbers.
+    STATE_HEX,             // Parsing a hexadecimal number.
+    STATE_BINARY,          // Parsing a binary number.
+};
+
+/**
+ * The number of values of `TokenizerState`.
+ */
+inline constexpr size_t tokenizer_state_count = TokenizerState::STATE_BINARY + 1;
+
+/**
+ * Returns the name of a tokenizer state, e.g. "STATE_WORD".
+ */
+std::string_view getTokenizerStateName(TokenizerState state);
+
+/**
+ * True if the library was built with `SIMPLEJAVALEXER_LEXER_STATS`, so that `lexerStats` counts.
+ */
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+inline constexpr bool lexer_stats_enabled = true;
+#else
+inline constexpr bool lexer_stats_enabled = false;
+#endif
+
+/**
+ * Counters of where lexing time goes, per tokenizer state, collected only in builds with
+ * `SIMPLEJAVALEXER_LEXER_STATS` defined (the CMake option of the same name).
+ *
+ * Every counter is indexed by the state the lexer was in when the work started. Measuring
+ * every step would cost more than the step itself, so only about one in `lexer_stats_sample_interval`
+ * steps is timed, picked at random so that periodic input does not bias the sample;
+ * `estimatedCycles` scales the sampled cycles to all steps.
+ */
+struct LexerStats {
+    uint64_t bytes[tokenizer_state_count]{};          // Characters consumed.
+    uint64_t tokens[tokenizer_state_count]{};         // Tokens output.
+    uint64_t redispatches[tokenizer_state_count]{};   // Characters handed back to be processed again in a new state.
+    uint64_t steps[tokenizer_state_count]{};          // Steps of the state machine (one character or one span).
+    uint64_t sampledSteps[tokenizer_state_count]{};   // Steps whose duration was measured.
+    uint64_t sampledCycles[tokenizer_state_count]{};  // Time of the measured steps, in TSC cycles on x86 and nanoseconds elsewhere.
+
+    LexerStats &operator+=(const LexerStats &other);
+
+    /**
+     * Estimates the cycles spent in a state from the sampled steps.
+     */
+    [[nodiscard]] double estimatedCycles(TokenizerState state) const {
+        return sampledSteps[state] == 0 ? 0 : (double) sampledCycles[state] * (double) steps[state] /
+                                              (double) sampledSteps[state];
+    }
+};
+
+/**
+ * About one in this many steps of the state machine is timed for `LexerStats::sampledCycles`; a power of two.
+ */
+inline constexpr uint64_t lexer_stats_sample_interval = 16;
+
+/**
+ * Returns the counters of all lexers destroyed so far, on any thread.
+ * Always zero unless `lexer_stats_enabled`.
+ */
+LexerStats lexerStats();
+
+/**
+ * Sets the counters returned by `lexerStats` back to zero.
+ */
+void resetLexerStats();
+
+/**
+ * Struct representing additional information when parsing numbers.
+ */
+struct NumberInfo {
+    bool hasUsedDot;  // True if the number contains a decimal point.
+    bool hasUsedE;    // True if the number contains an exponent ('e' or 'E').
+};
+
+/**
+ * The implementations that can lex a whole source (see `LexOptions::engine`).
+ */
+enum class LexerEngine {
+    STATE_MACHINE,  // The character-by-character state machine of `Lexer`.
+    DFA,            // The table-driven DFA generated at compile time (see `tokenizeDfa`).
+};
+
+/**
+ * Options that control what the lexer computes.
+ */
+struct LexOptions {
+    // Compute the line and column of every token. When false, both are left at 0 and only the
+    // index is set, which keeps the inner loop cheaper; use a `LineIndex` to resolve positions.
+    bool trackPositions = true;
+
+    // Mask of the token types to emit, built from `tokenTypeBit`. Tokens of other types are
+    // dropped before they are stored, but they still end the tokens around them as usual, e.g.
+    // `all_token_types & ~tokenTypeBit(WHITESPACE)` skips whitespace.
+    uint32_t emitTypes = all_token_types;
+
+    // Table that assigns the `id` of every `IDENTIFIER` token, and of every `CONTEXTUAL_KEYWORD`
+    // except `non-sealed`, since those words are also valid identifiers; nullptr leaves ids unset.
+    // It may be shared by lexers running on several threads.
+    IdentifierInterner *interner = nullptr;
+
+    // Compute the value of every `NUMBER`, `HEX_NUMBER` and `BINARY_NUMBER` token while lexing,
+    // in `number`, `numberKind` and `numberOverflow` (see `parseNumberLiteral`).
+    bool parseNumbers = false;
+
+    // The engine used by `tokenize` and `tokenize_view` to lex a whole source; both produce the
+    // same tokens. `Lexer`, `PushLexer`, line snapshots and ranges always use the state machine.
+    LexerEngine engine = LexerEngine::STATE_MACHINE;
+};
+
+/**
+ * The complete state of a `Lexer` between two characters, from which lexing can resume.
+ *
+ * At the start of a line the lexer is always either in `STATE_NONE` or inside a block comment or
+ * a text block (every other state ends at a newline), so a snapshot taken there is small and cheap to compare.
+ */
+struct LexerSnapshot {
+    TokenizerState state;               // Tokenizer state before the next character.
+    struct Position position;           // Position of the next character to process.
+    struct Position blockCommentStart;  // Where the pending block comment or text block started, if in either state.
+    struct NumberInfo numberInfo;       // Additional information about a pending number.
+    int wordStart;                      // Index where the pending lexeme starts; `position.index` if none.
+    char prev_c;                        // The character before `position`.
+    bool hasEmitted;                    // True if any token was emitted before `position`.
+    TokenType lastType;                 // Type of the last token emitted before `position`.
+
+    /**
+     * Checks if a whitespace character at `position` would be merged rather than emitted,
+     * which is the case at the start of the source and right after a `WHITESPACE` token.
+     */
+    [[nodiscard]] bool mergesWhitespace() const {
+        return !hasEmitted || lastType == TokenType::WHITESPACE;
+    }
+};
+
+/**
+ * Pull-based Java lexer that produces one token at a time.
+ *
+ * The lexer keeps the whole tokenizer state machine (current state, position, number info and
+ * the start of a pending block comment or text block) as member state, so tokens are produced
+ * on demand and the caller can stop at any point, e.g. after the import section, without lexing
+ * the rest of the file. Tokens are the same as those produced by `tokenize_view`, and their lexemes are views
+ * into the source, which must outlive the lexer and its tokens.
+ *
+ * The lexer is also an input range:
+ * ```
+ * Lexer lexer(source);
+ * for (const TokenView &token : lexer) { ... }
+ * ```
+ */
+class Lexer {
+public:
+    /**
+     * Input iterator over the remaining tokens of a lexer.
+     */
+    class iterator {
+    public:
+        using value_type = TokenView;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+        iterator() = default;
+
+        explicit iterator(Lexer *lexer) : lexer(lexer), current(lexer->next()) {}
+
+        const TokenView &operator*() const {
+            return *current;
+        }
+
+        const TokenView *operator->() const {
+            return &*current;
+        }
+
+        iterator &operator++() {
+            current = lexer->next();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return !current.has_value();
+        }
+
+    private:
+        Lexer *lexer = nullptr;
+        std::optional<TokenView> current;
+    };
+
+    /**
+     * Creates a lexer over the given Java source code.
+     * @param source - The Java source code; must outlive the lexer and its tokens.
+     * @param options - What to compute for every token, and which token types to emit.
+     */
+    explicit Lexer(std::string_view source, const LexOptions &options = {});
+
+    /**
+     * Creates a lexer that resumes lexing `source` from a snapshot.
+     * @param source - The whole Java source code the snapshot was taken from.
+     * @param snapshot - The state to resume from.
+     * @param options - What to compute for every token, and which token types to emit.
+     */
+    Lexer(std::string_view source, const LexerSnapshot &snapshot, const LexOptions &options = {});
+
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    /**
+     * Adds the counters of this lexer to those returned by `lexerStats`.
+     */
+    ~Lexer();
+#endif
+
+    /**
+     * Returns the current state of the lexer, including tokens emitted but not yet returned by `next`.
+     */
+    [[nodiscard]] LexerSnapshot snapshot() const;
+
+    /**
+     * Produces the next token.
+     * @return The next token, or `std::nullopt` once the whole source has been tokenized.
+     */
+    std::optional<TokenView> next();
+
+    /**
+     * Tokenizes the remainder of the source, appending every remaining token to `tokens`.
+     * @param tokens - The vector that receives the tokens.
+     */
+    void drain(std::vector<TokenView> &tokens);
+
+    /**
+     * Tokenizes the source up to, but excluding, the character at `index`,
+     * appending every finalized token to `tokens`. A token that is still pending at `index`
+     * is not finalized. `index` should be the start of a line: other characters may be
+     * skipped over as part of a number or a `::` symbol.
+     * @param index - Index of the first character not to process.
+     * @param tokens - The vector that receives the tokens.
+     */
+    void drainUntil(int index, std::vector<TokenView> &tokens);
+
+    /**
+     * Returns an iterator over the remaining tokens; advancing it consumes them from the lexer.
+     */
+    iterator begin() {
+        return iterator(this);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+
+private:
+    friend class PushLexer;
+
+    std::string_view source;                       // The source code being tokenized.
+    TokenizerState state = STATE_NONE;             // Current tokenizer state.
+    struct Position position = {
+            .index = 0,
+            .line = 1,
+            .column = 1
+    };                                             // Index and line of the character being processed.
+    int lineStart = 0;                             // Index in `source` of the first character of the line.
+    bool trackPositions = true;                    // False if lines and columns are not computed.
+    uint32_t emitTypes = all_token_types;          // Mask of the token types that are output.
+    IdentifierInterner *interner = nullptr;        // Table assigning identifier IDs, if any.
+    bool parseNumbers = false;                     // True if the values of numbers are computed.
+    struct Position blockCommentPositionSaver{};   // Position where the pending block comment or text block started.
+    struct NumberInfo numberInfo{};                // Additional information about the pending number.
+    std::string_view word;                         // The lexeme being accumulated, a view into `source`.
+    char prev_c = '\0';                            // Previously processed character.
+    bool isEOF = false;                            // True while finalizing the last token.
+    bool hasEmitted = false;                       // True once any token has been emitted.
+    TokenType lastType = TokenType::UNKNOWN;       // Type of the last emitted token.
+    std::vector<TokenView> pending;                // Tokens produced but not yet returned by `next`.
+    size_t pendingIndex = 0;                       // Index of the next pending token to return.
+    std::vector<TokenView> *output = &pending;     // Where emitted tokens are appended.
+    bool hasMoreInput = false;                     // True if more input may follow the end of `source`.
+    int indexBase = 0;                             // Absolute index of `source[0]` in the whole input.
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    LexerStats stats;                              // Counters of this lexer, see `lexerStats`.
+    uint32_t sampleSeed = 0x9E3779B9;              // State of the generator that picks the timed steps.
+#endif
+
+    [[nodiscard]] bool canStep() const;
+
+    [[nodiscard]] long retainedOffset() const;
+
+    void rebind(std::string_view newSource, int droppedPrefix, long wordOffset);
+
+    void step();
+
+    bool skipSpan();
+
+    void finishSource();
+
+    bool dispatch(char c, char next_c);
+
+    [[nodiscard]] struct Position positionOf(int index) const;
+
+    void emit(TokenType type, std::string_view lexeme, int indexOffset);
+
+    void emitAt(TokenType type, std::string_view lexeme, struct Position start);
+
+    void consume(char c, char next_c);
+
+    bool consumeWord(char c);
+
+    void consumeLineComment(char c);
+
+    void consumeBlockComment(char c);
+
+    void consumeLiteralString(char c);
+
+    void consumeTextBlock(char c);
+
+    void consumeLiteralChar(char c);
+
+    bool consumeOperator(char c, char next_c);
+
+    bool consumeNumber(char c, char next_c);
+
+    bool consumeHexAndBinary(char c, bool isBinary);
+};
 
 /**
  * Tokenizes the given Java source code into a sequence of tokens.
  * @param source - The Java source code as a string.
+ * @param options - What to compute for every token, and which token types to emit.
  * @return A vector of tokens representing the lexical elements of the source code.
  */
-std::vector<Token> tokenize(const std::string &source);
+std::vector<Token> tokenize(const std::string &source, const LexOptions &options = {});
+
+/**
+ * Tokenizes the given Java source code into a caller-owned vector that is reused between calls.
+ * The previous contents are replaced, but the capacity of the vector and of the lexemes of the
+ * tokens it already holds are kept, so lexing many files in a row rarely allocates.
+ * @param source - The Java source code as a string.
+ * @param tokens - The vector that receives the tokens.
+ * @param options - What to compute for every token, and which token types to emit.
+ */
+void tokenize(const std::string &source, std::vector<Token> &tokens, const LexOptions &options = {});
+
+/**
+ * Tokenizes the given Java source code without copying any lexeme.
+ * Produces the same token types and positions as `tokenize`, but every lexeme
+ * is a view into `source`, so the source must outlive the returned tokens.
+ * @param source - The Java source code.
+ * @param options - What to compute for every token, and which token types to emit.
+ * @return A vector of tokens whose lexemes point into `source`.
+ */
+std::vector<TokenView> tokenize_view(std::string_view source, const LexOptions &options = {});
+
+/**
+ * Tokenizes the given Java source code without copying any lexeme, into a caller-owned vector
+ * that is cleared but keeps its capacity.
+ * @param source - The Java source code.
+ * @param tokens - The vector that receives the tokens.
+ * @param options - What to compute for every token, and which token types to emit.
+ */
+void tokenize_view(std::string_view source, std::vector<TokenView> &tokens, const LexOptions &options = {});
+
+/**
+ * Tokenizes the given Java source code without copying any lexeme, and records the state of the
+ * lexer at the start of every line, so that `tokenizeRange` can later lex any range of lines
+ * without lexing the lines above it.
+ * @param source - The Java source code.
+ * @param tokens - The vector that receives the tokens; it is cleared but keeps its capacity.
+ * @param lineSnapshots - Receives one snapshot per line: element `i` is the state at the start of line `i + 1`.
+ * @param options - What to compute for every token, and which token types to emit.
+ */
+void tokenize_view(std::string_view source, std::vector<TokenView> &tokens,
+                   std::vector<LexerSnapshot> &lineSnapshots, const LexOptions &options = {});
+
+/**
+ * Tokenizes only the lines `[startLine, endLine)` of the given Java source code, resuming from the
+ * snapshot of `startLine`, e.g. to highlight the visible part of a large file.
+ * The result holds every token that overlaps these lines, exactly as `tokenize_view` would produce
+ * it, including a block comment that starts above `startLine` or ends below `endLine`.
+ * @param source - The Java source code the snapshots were recorded from.
+ * @param startLine - The first line to tokenize (1-based).
+ * @param endLine - The line after the last line to tokenize; clamped to the number of lines.
+ * @param lineSnapshots - The line snapshots recorded by `tokenize_view`, with the same `trackPositions` option.
+ * @param options - What to compute for every token, and which token types to emit.
+ * @return The tokens of the range, whose lexemes point into `source`.
+ */
+std::vector<TokenView> tokenizeRange(std::string_view source, int startLine, int endLine,
+                                     const std::vector<LexerSnapshot> &lineSnapshots,
+                                     const LexOptions &options = {});
+
+/**
+ * Estimates how many tokens a source produces, so that outputs can be reserved up front.
+ * @param bytes - The size of the source in bytes.
+ * @param emitTypes - The token types that are emitted (see `LexOptions::emitTypes`).
+ * @return An estimate that is slightly high for typical Java source.
+ */
+size_t estimateTokenCount(size_t bytes, uint32_t emitTypes = all_token_types);
+
+/**
+ * Result of `tokenizeFile`: the file contents together with the tokens that point into them.
+ */
+struct TokenizedFile {
+    SourceFile source;              // The (memory-mapped) contents of the file.
+    std::vector<TokenView> tokens;  // Tokens whose lexemes are views into `source`.
+};
+
+/**
+ * Tokenizes a Java source file directly from disk.
+ * The file is memory-mapped where supported, so lexing reads straight from the mapped pages
+ * and neither the file nor any lexeme is copied.
+ * @param path - The path of the Java source file.
+ * @return The file contents and its tokens.
+ * @throws std::system_error if the file cannot be opened or read.
+ */
+TokenizedFile tokenizeFile(const std::string &path);
+
+/**
+ * Result of `tokenizeOwned`: tokens together with the arena that owns their lexemes.
+ */
+struct OwnedTokens {
+    LexemeArena lexemes;            // Copies of the lexemes of `tokens`.
+    std::vector<TokenView> tokens;  // Tokens whose lexemes are views into `lexemes`.
+};
+
+/**
+ * Tokenizes the given Java source code and copies the lexemes of the emitted tokens into an
+ * arena owned by the result, so the tokens outlive the source. All lexemes share a single
+ * allocation instead of one `std::string` per token, and are freed together with the result.
+ * @param source - The Java source code; it is only needed during the call.
+ * @param options - What to compute for every token, and which token types to emit.
+ * @return The tokens and the arena holding their lexemes.
+ */
+OwnedTokens tokenizeOwned(std::string_view source, const LexOptions &options = {});
 
 #endif //SIMPLEJAVALEXER_LEXER_H
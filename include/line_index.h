@@ -0,0 +1,90 @@
+#ifndef SIMPLEJAVALEXER_LINE_INDEX_H
+#define SIMPLEJAVALEXER_LINE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "token.h"
+
+/**
+ * Computes the position of an offset from the start offsets of the lines of a source.
+ * @param lineStarts - Offset of the first character of every line, in increasing order, starting with 0.
+ * @param offset - The offset of a character in the source.
+ * @return The position, with a 1-based line and column.
+ */
+struct Position positionInLines(std::span<const uint32_t> lineStarts, uint32_t offset);
+
+/**
+ * Start offsets of the lines of a source, used to turn an offset into a line and a column.
+ *
+ * Building the index is a single scan for newlines with `memchr`, which the C library
+ * vectorizes, and resolving a position is a binary search, so lines and columns can be
+ * computed only for the tokens that need them (see `LexOptions::trackPositions`).
+ */
+class LineIndex {
+public:
+    LineIndex() = default;
+
+    /**
+     * Records where every line of the source starts.
+     * @param source - The source code.
+     */
+    explicit LineIndex(std::string_view source);
+
+    /**
+     * Copies line starts recorded earlier, e.g. by `starts()`.
+     * @param lineStarts - Offset of the first character of every line, starting with 0.
+     */
+    explicit LineIndex(std::span<const uint32_t> lineStarts) : lineStarts(lineStarts.begin(), lineStarts.end()) {}
+
+    /**
+     * Returns the number of lines, which is one more than the number of newlines.
+     */
+    [[nodiscard]] size_t lineCount() const {
+        return lineStarts.size();
+    }
+
+    /**
+     * Computes the position of an offset in the source.
+     * @param offset - The offset of a character in the source.
+     * @return The position, with a 1-based line and column.
+     */
+    [[nodiscard]] struct Position position(uint32_t offset) const {
+        return positionInLines(lineStarts, offset);
+    }
+
+    /**
+     * Returns the offset of the first character of every line.
+     */
+    [[nodiscard]] std::span<const uint32_t> starts() const {
+        return lineStarts;
+    }
+
+    /**
+     * Updates the index after a part of the source was replaced.
+     * @param offset - Offset of the first replaced character.
+     * @param removed - Number of characters removed at `offset`.
+     * @param inserted - The text inserted at `offset`.
+     */
+    void edit(uint32_t offset, uint32_t removed, std::string_view inserted);
+
+    /**
+     * Fills in the line and column of tokens lexed without tracking positions.
+     * @param tokens - Tokens of the indexed source.
+     */
+    void resolve(std::span<TokenView> tokens) const;
+
+    /**
+     * Returns the number of bytes allocated by the index.
+     */
+    [[nodiscard]] size_t memoryUsage() const {
+        return lineStarts.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<uint32_t> lineStarts{0};    // Offset of the first character of every line.
+};
+
+#endif //SIMPLEJAVALEXER_LINE_INDEX_H
@@ -2,6 +2,8 @@
 #define SIMPLEJAVALEXER_NUMBER_HELPER_H
 
 #include <iostream>
+#include <string_view>
+#include "token.h"
 
 /**
  * Checks if a character is a decimal digit (0-9).
@@ -64,9 +66,36 @@ bool isNumberInRange(char c, bool isBinary, bool isHex);
  * @param index The current position of the `_` in the string.
  * @param isBinary A flag indicating whether the number is in binary format.
  * @param isHex A flag indicating whether the number is in hexadecimal format.
- * @return A string containing the consumed valid numeric segment with underscores, or an empty
- *         string if the underscores are invalid.
+ * @return A view into `source` covering the consumed valid numeric segment with underscores,
+ *         or an empty view if the underscores are invalid.
  */
-std::string consumeUnderscoreInNumber(const std::string &source, int index, bool isBinary, bool isHex);
+std::string_view consumeUnderscoreInNumber(std::string_view source, int index, bool isBinary, bool isHex);
+
+/**
+ * The value of a numeric literal, as computed by `parseNumberLiteral`.
+ */
+struct NumberLiteral {
+    NumberKind kind = NumberKind::NONE;  // The Java type of the literal; `NONE` if it is invalid.
+    bool overflow = false;               // True if the literal is out of the range of its type.
+    NumberValue value{};                 // The value, see `NumberKind`.
+};
+
+/**
+ * Computes the value of a numeric literal the lexer has just accepted.
+ *
+ * Underscores are dropped, the suffix selects the type, and the digits are converted with
+ * `std::from_chars`. Follows the Java rules: decimal integers with a leading zero are octal,
+ * hexadecimal, octal and binary `int` and `long` literals may use all 32 or 64 bits (so
+ * `0xFFFFFFFF` is -1), and decimal ones may not exceed `Integer.MAX_VALUE` or `Long.MAX_VALUE`.
+ * The decimal literals `2147483648` and `9223372036854775808L`, which are only valid after
+ * a unary minus, are flagged as overflowing but keep their value (modulo 2^64), so negating
+ * them gives the right result. Floating-point literals that round to infinity, or to zero although
+ * they are not zero, are flagged as well, with the infinite or zero value.
+ *
+ * @param type - `NUMBER`, `HEX_NUMBER` or `BINARY_NUMBER`.
+ * @param lexeme - The lexeme of the literal, including underscores and suffix.
+ * @return The value, or a `NONE` literal if the lexeme is not a valid literal (e.g. `09` or `1e`).
+ */
+NumberLiteral parseNumberLiteral(TokenType type, std::string_view lexeme);
 
 #endif //SIMPLEJAVALEXER_NUMBER_HELPER_H
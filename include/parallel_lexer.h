@@ -0,0 +1,37 @@
+#ifndef SIMPLEJAVALEXER_PARALLEL_LEXER_H
+#define SIMPLEJAVALEXER_PARALLEL_LEXER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "thread_pool.h"
+
+/**
+ * Options for `tokenizeParallel`.
+ */
+struct ParallelOptions {
+    ThreadPool *pool = nullptr;          // Pool to run on; nullptr uses `ThreadPool::shared()`.
+    size_t segmentSize = 1 << 20;        // Approximate number of bytes lexed by one task.
+    size_t checkpointInterval = 1 << 16; // Approximate distance in bytes between two resync points.
+};
+
+/**
+ * Tokenizes one large Java source on several threads.
+ *
+ * The source is split into segments at line starts, and every segment is lexed speculatively
+ * and in parallel as if no token or comment were open at its start, which is the common case.
+ * The seams are then repaired in order: when a segment actually starts inside a block comment
+ * or a text block (the only states that survive a newline), it is lexed again from the true state
+ * until both runs agree at one of its checkpoints, after which the speculative tokens are reused.
+ * Lines are counted in a parallel pass first, so positions are correct without any fix-up.
+ *
+ * Sources that fit into a single segment are lexed sequentially.
+ *
+ * @param source - The Java source code; must outlive the returned tokens.
+ * @param options - How to split and run the work.
+ * @return The same tokens `tokenize_view` would produce.
+ */
+std::vector<TokenView> tokenizeParallel(std::string_view source, const ParallelOptions &options = {});
+
+#endif //SIMPLEJAVALEXER_PARALLEL_LEXER_H
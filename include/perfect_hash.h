@@ -0,0 +1,100 @@
+#ifndef SIMPLEJAVALEXER_PERFECT_HASH_H
+#define SIMPLEJAVALEXER_PERFECT_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Hashes a lexeme using only its length and its first, middle and last characters,
+ * so hashing is O(1) regardless of the lexeme's length.
+ * @param word - The lexeme to hash; must not be empty.
+ * @param seed - The seed that selects a member of the hash family.
+ * @return The 32-bit hash value.
+ */
+constexpr uint32_t hashLexeme(std::string_view word, uint32_t seed) {
+    uint32_t hash = (uint32_t) word.size() << 24 |
+                    (uint32_t) (unsigned char) word[0] << 16 |
+                    (uint32_t) (unsigned char) word[word.size() / 2] << 8 |
+                    (uint32_t) (unsigned char) word.back();
+    hash ^= seed * 0x9E3779B9u;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    return hash ^ (hash >> 16);
+}
+
+/**
+ * A compile-time perfect hash set of lexemes.
+ *
+ * The constructor searches for a seed under which no two words share a slot, so a lookup
+ * is a single hash, one slot load and one comparison, without any allocation. The search
+ * runs during constant evaluation; a word list that cannot be placed fails to compile.
+ *
+ * @tparam N - The number of words in the set.
+ * @tparam Size - The number of slots; must be a power of two larger than `N`.
+ */
+template<size_t N, size_t Size>
+class PerfectHashSet {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+    static_assert(Size > N, "Size must be larger than the number of words");
+    static_assert(N < 256, "Word indices are bytes");
+
+public:
+    constexpr explicit PerfectHashSet(const std::array<std::string_view, N> &words) {
+        for (uint32_t candidate = 0; candidate < 1000000; candidate++) {
+            if (tryPlace(words, candidate)) {
+                seed = candidate;
+                return;
+            }
+        }
+        throw "PerfectHashSet: no collision-free seed found";
+    }
+
+    /**
+     * Checks if the given lexeme is a member of the set.
+     * @param word - The lexeme to check.
+     * @return true if the lexeme is one of the words the set was built from; false otherwise.
+     */
+    [[nodiscard]] constexpr bool contains(std::string_view word) const {
+        if (word.empty()) {
+            return false;
+        }
+        return slots[hashLexeme(word, seed) & (Size - 1)] == word;
+    }
+
+    /**
+     * Finds the given lexeme in the set.
+     * @param word - The lexeme to find.
+     * @return The index of the lexeme in the words the set was built from, or `N` if it is not a member.
+     */
+    [[nodiscard]] constexpr size_t find(std::string_view word) const {
+        if (word.empty()) {
+            return N;
+        }
+        size_t slot = hashLexeme(word, seed) & (Size - 1);
+        return slots[slot] == word ? indices[slot] : N;
+    }
+
+private:
+    std::array<std::string_view, Size> slots{};
+    std::array<uint8_t, Size> indices{};  // Index of the word in every slot.
+    uint32_t seed = 0;
+
+    constexpr bool tryPlace(const std::array<std::string_view, N> &words, uint32_t candidate) {
+        slots = {};
+        for (size_t i = 0; i < N; i++) {
+            size_t slot = hashLexeme(words[i], candidate) & (Size - 1);
+            if (!slots[slot].empty()) {
+                return false;
+            }
+            slots[slot] = words[i];
+            indices[slot] = (uint8_t) i;
+        }
+        return true;
+    }
+};
+
+#endif //SIMPLEJAVALEXER_PERFECT_HASH_H
@@ -0,0 +1,72 @@
+#ifndef SIMPLEJAVALEXER_PIPELINE_H
+#define SIMPLEJAVALEXER_PIPELINE_H
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+#include "lexer.h"
+
+/**
+ * Options for `tokenizePipeline`.
+ */
+struct PipelineOptions {
+    LexOptions lexOptions;       // How every file is lexed.
+    unsigned threads = 0;        // Threads lexing and running the sink; 0 uses one per hardware thread.
+    size_t openFiles = 16;       // Files read and lexed at the same time.
+    size_t chunkSize = 1 << 16;  // Bytes per read; every open file has two chunks.
+    size_t blockSize = 4096;     // Tokens per block handed to the sink; the last block of a file may be smaller.
+    size_t queuedBlocks = 64;    // Blocks waiting for the sink before lexing pauses.
+    bool useIoUring = true;      // Read through io_uring where the kernel supports it, instead of I/O threads.
+};
+
+/**
+ * Consecutive tokens of one file, as handed to the sink.
+ */
+struct TokenBlock {
+    size_t file = 0;              // Index of the file in the paths.
+    size_t first = 0;             // Index of the first token in the tokens of the file.
+    std::vector<Token> tokens;    // The tokens, in source order.
+    bool last = false;            // True for the last block of the file, which may be empty.
+};
+
+/**
+ * Receives the blocks of a pipeline, one call at a time. The blocks of a file arrive in order;
+ * those of different files interleave. The sink may move the tokens out of the block.
+ */
+using TokenSink = std::function<void(TokenBlock &block)>;
+
+/**
+ * Totals of a pipeline run.
+ */
+struct PipelineStats {
+    size_t files = 0;             // Files lexed to the end.
+    size_t bytes = 0;             // Bytes read from them.
+    size_t tokens = 0;            // Tokens handed to the sink.
+    size_t blocks = 0;            // Blocks handed to the sink.
+    bool usedIoUring = false;     // True if the files were read through io_uring.
+};
+
+/**
+ * Reads, lexes and consumes many Java files as one pipeline of coroutines (see `async.h`).
+ *
+ * Every open file is a coroutine that reads the file in chunks, double-buffered so the next
+ * chunk is read while the current one is lexed by a `PushLexer`, and pushes its tokens in blocks
+ * of `blockSize` into a bounded channel. A single coroutine pops the blocks and hands them to the
+ * sink. When the sink falls behind, the channel fills up and the file coroutines suspend, so
+ * memory stays bounded by the open files, their chunks and the queued blocks, however many and
+ * however large the files are. Suspended coroutines hold no thread, and reads go through
+ * io_uring where available, so a few threads keep the disk, the lexer and the sink busy at once.
+ *
+ * @param paths - The files to lex.
+ * @param sink - Receives the tokens; it runs on one of the pipeline's threads.
+ * @param options - How to run the pipeline.
+ * @return The totals of the run.
+ * @throws std::system_error for the first file that cannot be read, once the other files are done;
+ *         an exception thrown by the sink, which stops the pipeline.
+ */
+PipelineStats tokenizePipeline(std::span<const std::string> paths, const TokenSink &sink,
+                               const PipelineOptions &options = {});
+
+#endif //SIMPLEJAVALEXER_PIPELINE_H
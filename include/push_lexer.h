@@ -0,0 +1,55 @@
+#ifndef SIMPLEJAVALEXER_PUSH_LEXER_H
+#define SIMPLEJAVALEXER_PUSH_LEXER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lexer.h"
+
+/**
+ * Push-based Java lexer for sources that arrive in chunks (e.g., over a socket).
+ *
+ * Each call to `feed` resumes the tokenizer state machine where the previous chunk left off,
+ * so lexing overlaps with receiving the rest of the source. Characters whose lookahead lies in
+ * a chunk that has not arrived yet (e.g., `/` before `/` or `*`, `0` before `x`, `:` before `:`,
+ * a run of underscores inside a number, or the bytes of a UTF-8 character or a Unicode escape)
+ * are held back until the next chunk or `finish`.
+ * The produced tokens are identical to those of `tokenize` on the concatenated chunks.
+ *
+ * Only the bytes of the token being lexed are buffered; everything before it is discarded,
+ * which is why finalized tokens own their lexemes.
+ */
+class PushLexer {
+public:
+    /**
+     * Creates a lexer waiting for the first chunk.
+     * @param options - What to compute for every token, and which token types to emit.
+     */
+    explicit PushLexer(const LexOptions &options = {});
+
+    /**
+     * Lexes the next chunk of the source.
+     * @param chunk - The next part of the source code; it is copied, so it need not outlive the call.
+     */
+    void feed(std::string_view chunk);
+
+    /**
+     * Signals the end of the source and finalizes any pending token.
+     */
+    void finish();
+
+    /**
+     * Returns the tokens finalized since the previous call and removes them from the lexer.
+     * @return The tokens finalized since the previous call, in source order.
+     */
+    std::vector<Token> takeTokens();
+
+private:
+    std::string buffer;         // Input from the start of the pending token onward.
+    Lexer lexer;                // State machine running over `buffer`.
+    std::vector<Token> tokens;  // Finalized tokens not yet taken by the caller.
+
+    void lexAvailable();
+};
+
+#endif //SIMPLEJAVALEXER_PUSH_LEXER_H
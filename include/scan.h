@@ -0,0 +1,60 @@
+#ifndef SIMPLEJAVALEXER_SCAN_H
+#define SIMPLEJAVALEXER_SCAN_H
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * Vectorized scanners that find the next character the lexer has to look at.
+ *
+ * Inside comments, string and char literals, and runs of blanks, almost every character
+ * only extends the pending lexeme. These scanners skip such spans 16 or 32 bytes at a time,
+ * so the lexer can take the whole span in one step. The kernel (AVX2, SSE2, NEON or scalar)
+ * is selected at runtime, the first time a scanner is used.
+ *
+ * The state machine only scans for newlines too, so it still sees every line break; the DFA
+ * engine counts the lines of a match afterwards and may skip them.
+ */
+
+/**
+ * Finds the first occurrence of either of two characters.
+ * @param text - The text to scan.
+ * @param from - Index to start scanning at.
+ * @param a - A character to stop at.
+ * @param b - Another character to stop at; may equal `a`.
+ * @return The index of the first `a` or `b` at or after `from`, or `text.size()` if there is none.
+ */
+size_t scanUntil(std::string_view text, size_t from, char a, char b);
+
+/**
+ * Finds where a block comment may end: at the next '/' preceded by '*', or at the next newline.
+ * @param text - The text to scan.
+ * @param from - Index to start scanning at.
+ * @param prev_c - The character before `from`, which may be the '*' of a closing sequence.
+ * @return The index of the first such '/' or '\n' at or after `from`, or `text.size()` if there is none.
+ */
+size_t scanBlockComment(std::string_view text, size_t from, char prev_c);
+
+/**
+ * Finds the next character in the body of a text block that is not just part of its content:
+ * a '"', which may be the first of the closing `"""`, a '\', which escapes the next character, or a newline.
+ * @param text - The text to scan.
+ * @param from - Index to start scanning at.
+ * @return The index of the first such character at or after `from`, or `text.size()` if there is none.
+ */
+size_t scanTextBlock(std::string_view text, size_t from);
+
+/**
+ * Skips blanks, which are all whitespace characters except the newline.
+ * @param text - The text to scan.
+ * @param from - Index to start scanning at.
+ * @return The index of the first non-blank character at or after `from`, or `text.size()` if there is none.
+ */
+size_t skipBlanks(std::string_view text, size_t from);
+
+/**
+ * Returns the name of the kernel selected for this CPU ("avx2", "sse2", "neon" or "scalar").
+ */
+std::string_view scanKernelName();
+
+#endif //SIMPLEJAVALEXER_SCAN_H
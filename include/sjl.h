@@ -0,0 +1,181 @@
+#ifndef SIMPLEJAVALEXER_SJL_H
+#define SIMPLEJAVALEXER_SJL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A C interface to the lexer, for embedding it through a foreign function interface.
+ *
+ * The interface only passes plain integers, pointers and C structs, so one call lexes a whole
+ * source and writes all of its tokens at once: either into arrays provided by the caller, one
+ * per field (types, offsets, lengths and optionally lines and columns), or as a token stream
+ * (see `token_stream.h`). No lexeme is copied; a token is the offset and length of its bytes
+ * in the source.
+ *
+ * A handle keeps its scratch memory between calls, so lexing many files into arrays with one
+ * handle does not allocate once the handle has seen the largest file. A handle must only be
+ * used by one thread at a time; separate handles are independent. No C++ exception crosses
+ * the interface.
+ *
+ * `libsjl`, the shared library built by CMake, exports these functions and none of the C++ API.
+ */
+
+#if defined(_WIN32) && defined(SJL_BUILD)
+#define SJL_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define SJL_API __declspec(dllimport)
+#elif defined(SJL_BUILD)
+#define SJL_API __attribute__((visibility("default")))
+#else
+#define SJL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The version of this interface, incremented on every incompatible change.
+ */
+#define SJL_API_VERSION 1
+
+/**
+ * Result of the functions of the interface.
+ */
+typedef enum sjl_status {
+    SJL_OK = 0,                // Success.
+    SJL_ERROR_ARGUMENT = 1,    // A required pointer is null, or an option is invalid.
+    SJL_ERROR_CAPACITY = 2,    // The output arrays are too small; `count` has the number of tokens.
+    SJL_ERROR_TOO_LARGE = 3,   // The source is 2 GiB or larger.
+    SJL_ERROR_MEMORY = 4,      // Memory could not be allocated.
+    SJL_ERROR_INTERNAL = 5,    // An unexpected error inside the library.
+} sjl_status;
+
+/**
+ * The token types, with the values of `TokenType`.
+ */
+typedef enum sjl_token_type {
+    SJL_KEYWORD = 0,
+    SJL_LINE_COMMENT = 1,
+    SJL_BLOCK_COMMENT = 2,
+    SJL_STRING = 3,
+    SJL_CHAR = 4,
+    SJL_IDENTIFIER = 5,
+    SJL_ANNOTATION = 6,
+    SJL_NUMBER = 7,
+    SJL_HEX_NUMBER = 8,
+    SJL_BINARY_NUMBER = 9,
+    SJL_OPERATOR = 10,
+    SJL_SYMBOL = 11,
+    SJL_WHITESPACE = 12,
+    SJL_CONTEXTUAL_KEYWORD = 13,
+    SJL_TEXT_BLOCK = 14,
+    SJL_UNKNOWN = 15,
+} sjl_token_type;
+
+/**
+ * The engines of `LexerEngine`; both produce the same tokens.
+ */
+typedef enum sjl_engine {
+    SJL_ENGINE_STATE_MACHINE = 0,
+    SJL_ENGINE_DFA = 1,
+} sjl_engine;
+
+/**
+ * Options of a handle. A zero-initialized struct selects the defaults.
+ */
+typedef struct sjl_options {
+    uint32_t emit_types;  // Mask of the token types to emit, bit `1 << type` per type; 0 emits every type.
+    uint32_t engine;      // A `sjl_engine`.
+} sjl_options;
+
+/**
+ * Caller-provided arrays that receive the tokens of a source, one array per field.
+ */
+typedef struct sjl_tokens {
+    uint8_t *types;     // The `sjl_token_type` of every token.
+    uint32_t *offsets;  // Offset of every lexeme in the source.
+    uint32_t *lengths;  // Length of every lexeme.
+    uint32_t *lines;    // Line of every token, starting at 1; may be null.
+    uint32_t *columns;  // Column of every token in bytes, starting at 1; may be null.
+    size_t capacity;    // Number of elements of every non-null array.
+    size_t count;       // Set to the number of tokens of the source, even if they did not fit.
+} sjl_tokens;
+
+/**
+ * A lexer handle, which owns the memory reused between calls.
+ */
+typedef struct sjl_lexer sjl_lexer;
+
+/**
+ * Returns `SJL_API_VERSION` of the library, to check it against that of the header.
+ */
+SJL_API uint32_t sjl_api_version(void);
+
+/**
+ * Creates a lexer handle.
+ * @param options - The options of the handle; null selects the defaults.
+ * @return The handle, to be released with `sjl_free`; null if the options are invalid or memory is exhausted.
+ */
+SJL_API sjl_lexer *sjl_lexer_create(const sjl_options *options);
+
+/**
+ * Releases a handle and everything it owns, including the last token stream. Null is ignored.
+ */
+SJL_API void sjl_free(sjl_lexer *lexer);
+
+/**
+ * Tokenizes a source into the caller's arrays.
+ *
+ * If the arrays are too small, nothing is written, `out->count` is set and the tokens are kept by
+ * the handle, so `sjl_copy_tokens` can write them after the arrays are grown, without lexing again.
+ * A capacity of 0 with null arrays only counts the tokens. Arrays of `sjl_estimate_token_count`
+ * elements hold the tokens of typical sources. Lines and columns are only computed if `lines`
+ * or `columns` is set.
+ *
+ * @param lexer - The handle.
+ * @param source - The bytes of the source; may be null if `length` is 0.
+ * @param length - The number of bytes of the source; less than 2 GiB.
+ * @param out - The arrays to write into; `count` is set on success and on `SJL_ERROR_CAPACITY`.
+ * @return `SJL_OK`, or the reason nothing was written.
+ */
+SJL_API sjl_status sjl_tokenize_into(sjl_lexer *lexer, const char *source, size_t length, sjl_tokens *out);
+
+/**
+ * Writes the tokens of the last source lexed by a handle into the caller's arrays.
+ * @param lexer - The handle.
+ * @param out - The arrays to write into; `count` is set on success and on `SJL_ERROR_CAPACITY`.
+ *              Lines or columns can only be written if they were computed for that source.
+ * @return `SJL_OK`, or the reason nothing was written.
+ */
+SJL_API sjl_status sjl_copy_tokens(const sjl_lexer *lexer, sjl_tokens *out);
+
+/**
+ * Tokenizes a source into a token stream, which `readTokenStream` and `loadTokenStream` accept
+ * and which can be stored or sent as it is.
+ * @param lexer - The handle, which owns the stream until its next call or `sjl_free`.
+ * @param source - The bytes of the source; may be null if `length` is 0.
+ * @param length - The number of bytes of the source; less than 2 GiB.
+ * @param data - Set to the first byte of the stream, which is 8-byte aligned.
+ * @param size - Set to the number of bytes of the stream.
+ * @return `SJL_OK`, or the reason no stream was written.
+ */
+SJL_API sjl_status sjl_tokenize_stream(sjl_lexer *lexer, const char *source, size_t length,
+                                       const uint8_t **data, size_t *size);
+
+/**
+ * Returns a number of tokens that a handle rarely exceeds for a source of `length` bytes.
+ */
+SJL_API size_t sjl_estimate_token_count(const sjl_lexer *lexer, size_t length);
+
+/**
+ * Returns the name of a token type, e.g. "IDENTIFIER", as a static null-terminated string.
+ */
+SJL_API const char *sjl_token_type_name(uint32_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //SIMPLEJAVALEXER_SJL_H
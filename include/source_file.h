@@ -0,0 +1,61 @@
+#ifndef SIMPLEJAVALEXER_SOURCE_FILE_H
+#define SIMPLEJAVALEXER_SOURCE_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only contents of a source file on disk.
+ *
+ * On platforms with `mmap` the file is mapped into memory and its pages are read directly,
+ * so no copy of the file is ever made. Elsewhere the file is read once into an owned buffer.
+ * Either way the contents stay at the same address for the lifetime of the object, even
+ * when it is moved, so views into `contents()` remain valid until it is destroyed.
+ */
+class SourceFile {
+public:
+    /**
+     * Opens and maps (or reads) the given file.
+     * @param path - The path of the file to open.
+     * @throws std::system_error if the file cannot be opened or read.
+     */
+    explicit SourceFile(const std::string &path);
+
+    SourceFile(SourceFile &&other) noexcept;
+
+    SourceFile &operator=(SourceFile &&other) noexcept;
+
+    SourceFile(const SourceFile &) = delete;
+
+    SourceFile &operator=(const SourceFile &) = delete;
+
+    ~SourceFile();
+
+    /**
+     * Returns the contents of the file.
+     * @return A view over the whole file.
+     */
+    [[nodiscard]] std::string_view contents() const {
+        return {data, size};
+    }
+
+    /**
+     * Checks if the contents are memory-mapped rather than read into a buffer.
+     * @return true if the file is memory-mapped; false otherwise.
+     */
+    [[nodiscard]] bool isMapped() const {
+        return mapped;
+    }
+
+private:
+    const char *data = nullptr;     // Start of the file contents.
+    size_t size = 0;                // Size of the file contents in bytes.
+    bool mapped = false;            // True if `data` points to a memory mapping.
+    std::unique_ptr<char[]> buffer; // Owned contents when the file is not mapped.
+
+    void release();
+};
+
+#endif //SIMPLEJAVALEXER_SOURCE_FILE_H
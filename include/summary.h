@@ -0,0 +1,59 @@
+#ifndef SIMPLEJAVALEXER_SUMMARY_H
+#define SIMPLEJAVALEXER_SUMMARY_H
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include "token.h"
+
+/**
+ * Number of import declarations whose names a `SourceSummary` keeps.
+ */
+inline constexpr size_t summary_import_count = 16;
+
+/**
+ * Aggregate facts about one Java source, as computed by `summarize`.
+ *
+ * Lines are classified like `cloc` does: a line with any token other than a comment or
+ * whitespace is code, even if it also has a comment; a line with comments and whitespace only
+ * is a comment line; any other line is blank. Text blocks count as code on every line they span.
+ */
+struct SourceSummary {
+    std::array<size_t, TokenType::UNKNOWN + 1> tokenCounts{};  // Number of tokens of every type, indexed by `TokenType`.
+    size_t tokens = 0;             // Number of tokens of all types.
+    size_t lines = 0;              // Number of lines, counting a last line without a line break; 0 if empty.
+    size_t codeLines = 0;          // Lines with code.
+    size_t commentLines = 0;       // Lines with comments and no code.
+    size_t blankLines = 0;         // Lines with neither.
+    size_t longestLine = 0;        // Length in bytes of the longest line, without its line break.
+    size_t longestLineNumber = 0;  // Line number of the first line of that length, starting at 1; 0 if empty.
+    std::string_view packageName;  // The name of the package declaration as written, e.g. "com.example"; empty if none.
+    size_t importCount = 0;        // Number of import declarations, static or not.
+    size_t staticImportCount = 0;  // Number of static import declarations.
+    // Names of the first `summary_import_count` imports as written, e.g. "java.util.*" or, for
+    // `import static`, "java.lang.Math.max".
+    std::array<std::string_view, summary_import_count> imports{};
+
+    /**
+     * Returns the number of comment lines per code line, 0 if there is no code.
+     */
+    [[nodiscard]] double commentToCodeRatio() const {
+        return codeLines == 0 ? 0.0 : (double) commentLines / (double) codeLines;
+    }
+};
+
+/**
+ * Computes aggregate facts about a source without storing its tokens.
+ *
+ * The tokens come from the same state machine as `tokenize`, pulled one at a time from a
+ * `Lexer`, which reuses its small buffer of pending tokens, so nothing is allocated per token.
+ * Each token only updates a few counters, apart from those of package and import declarations,
+ * whose names are kept as views. Instead of having the lexer track positions, the lines of the
+ * tokens are found by `memchr` as they advance, which also measures every line.
+ *
+ * @param source - The Java source code; must outlive the views in the summary.
+ * @return The summary, whose token counts match those of `tokenize`.
+ */
+SourceSummary summarize(std::string_view source);
+
+#endif //SIMPLEJAVALEXER_SUMMARY_H
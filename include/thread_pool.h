@@ -0,0 +1,92 @@
+#ifndef SIMPLEJAVALEXER_THREAD_POOL_H
+#define SIMPLEJAVALEXER_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that run batches of independent tasks with work stealing.
+ *
+ * Each worker owns a queue of task indices. Tasks of a batch are dealt round-robin to the
+ * queues in the order given, so when the order is "largest first" every worker starts on one
+ * of the largest tasks. A worker takes tasks from the front of its own queue, and once it is
+ * empty it steals from the back of the other queues, so a few huge tasks never leave the
+ * remaining workers idle.
+ */
+class ThreadPool {
+public:
+    /**
+     * The function run for every task: receives the task index and the index of the worker
+     * running it, which identifies per-worker scratch state.
+     */
+    using Task = std::function<void(size_t task, unsigned worker)>;
+
+    /**
+     * Starts the worker threads.
+     * @param threads - Number of workers; 0 uses the number of hardware threads.
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * Returns the pool used when a caller does not provide one,
+     * with one worker per hardware thread. It is created on first use.
+     */
+    static ThreadPool &shared();
+
+    /**
+     * Returns the number of worker threads.
+     */
+    [[nodiscard]] unsigned size() const {
+        return (unsigned) workers.size();
+    }
+
+    /**
+     * Runs `body` for every task in `order` and blocks until all of them have finished.
+     * Batches are run one at a time; concurrent calls are serialized, so a task must not call
+     * `run` on the pool running it, which would deadlock.
+     * @param order - The task indices, in the order they should be started.
+     * @param body - The function to run for each task.
+     * @throws The first exception thrown by a task, once all the tasks of the batch have finished.
+     */
+    void run(std::span<const size_t> order, const Task &body);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex runMutex;            // Serializes calls to `run`.
+    std::mutex stateMutex;          // Guards the fields below.
+    std::condition_variable wakeUp; // Signals workers that a batch started or the pool stops.
+    std::condition_variable idle;   // Signals `run` that the batch finished.
+    const Task *body = nullptr;     // The function of the current batch.
+    size_t generation = 0;          // Incremented for every batch.
+    size_t remaining = 0;           // Tasks of the current batch that have not finished.
+    unsigned active = 0;            // Workers currently taking or running tasks of the batch.
+    std::exception_ptr error;       // The first exception thrown by a task of the batch.
+    bool stopping = false;          // True once the pool is being destroyed.
+
+    void work(unsigned worker);
+
+    bool takeTask(unsigned worker, size_t &task);
+};
+
+#endif //SIMPLEJAVALEXER_THREAD_POOL_H
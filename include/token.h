@@ -1,28 +1,74 @@
 #ifndef SIMPLEJAVALEXER_TOKEN_H
 #define SIMPLEJAVALEXER_TOKEN_H
 
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 /**
  * Enum representing the types of tokens in the lexer.
  */
 enum TokenType {
-    KEYWORD,         // Java keywords (e.g., "class", "if", "while").
-    LINE_COMMENT,    // Single-line comments (e.g., "// comment").
-    BLOCK_COMMENT,   // Multi-line comments (e.g., "/* comment */").
-    STRING,          // String literals (e.g., "\"hello\"").
-    CHAR,            // Character literals (e.g., '\'a\'').
-    IDENTIFIER,      // Identifiers (e.g., variable or method names).
-    ANNOTATION,      // Java annotations (e.g., "@Override").
-    NUMBER,          // Numeric literals (e.g., "123").
-    HEX_NUMBER,      // Hexadecimal numbers (e.g., "0x1A3F").
-    BINARY_NUMBER,   // Binary numbers (e.g., "0b1010").
-    OPERATOR,        // Operators (e.g., "+", "==", "&&").
-    SYMBOL,          // Symbols (e.g., ";", "{", "}").
-    WHITESPACE,      // Whitespace (spaces, tabs, newlines).
-    UNKNOWN          // Unrecognized tokens.
+    KEYWORD,            // Java keywords (e.g., "class", "if", "while").
+    LINE_COMMENT,       // Single-line comments (e.g., "// comment").
+    BLOCK_COMMENT,      // Multi-line comments (e.g., "/* comment */").
+    STRING,             // String literals (e.g., "\"hello\"").
+    CHAR,               // Character literals (e.g., '\'a\'').
+    IDENTIFIER,         // Identifiers (e.g., variable or method names).
+    ANNOTATION,         // Java annotations (e.g., "@Override").
+    NUMBER,             // Numeric literals (e.g., "123").
+    HEX_NUMBER,         // Hexadecimal numbers (e.g., "0x1A3F").
+    BINARY_NUMBER,      // Binary numbers (e.g., "0b1010").
+    OPERATOR,           // Operators (e.g., "+", "==", "&&").
+    SYMBOL,             // Symbols (e.g., ";", "{", "}").
+    WHITESPACE,         // Whitespace (spaces, tabs, newlines).
+    CONTEXTUAL_KEYWORD, // Words that are keywords only in some places (e.g., "record", "var", "non-sealed").
+    TEXT_BLOCK,         // Multi-line string literals (e.g., "\"\"\"\nhello\"\"\"").
+    UNKNOWN             // Unrecognized tokens.
 };
 
+/**
+ * Returns the bit that selects a token type in a token type mask (see `LexOptions::emitTypes`).
+ */
+constexpr uint32_t tokenTypeBit(TokenType type) {
+    return 1u << type;
+}
+
+/**
+ * Token type mask selecting every token type.
+ */
+inline constexpr uint32_t all_token_types = (1u << (TokenType::UNKNOWN + 1)) - 1;
+
+/**
+ * Token type mask selecting line and block comments.
+ */
+inline constexpr uint32_t comment_token_types = tokenTypeBit(LINE_COMMENT) | tokenTypeBit(BLOCK_COMMENT);
+
+/**
+ * The type of the value of a numeric literal, following its Java type.
+ */
+enum class NumberKind : uint8_t {
+    NONE,    // Not a number token, values were not computed, or the literal is invalid.
+    INT,     // An `int` literal, in `NumberValue::integer`.
+    LONG,    // A `long` literal (suffix 'l' or 'L'), in `NumberValue::integer`.
+    FLOAT,   // A `float` literal (suffix 'f' or 'F'), in `NumberValue::floating`.
+    DOUBLE,  // A `double` literal, in `NumberValue::floating`.
+};
+
+/**
+ * The value of a numeric literal (see `LexOptions::parseNumbers`); `NumberKind` tells which member is set.
+ */
+union NumberValue {
+    int64_t integer;  // Value of an `INT` or `LONG` literal.
+    double floating;  // Value of a `FLOAT` or `DOUBLE` literal, converted exactly from `float` for `FLOAT`.
+};
+
+/**
+ * The `id` of tokens that have no interned identifier (see `IdentifierInterner`).
+ */
+inline constexpr uint32_t no_identifier_id = UINT32_MAX;
+
 /**
  * Struct representing the position of a token in the source code.
  * This includes the index, line number, and column number.
@@ -33,14 +79,95 @@ struct Position {
     int column; // Column number in the source code (1-based).
 };
 
+/**
+ * Returns the name of a token type as a string.
+ * @param type - The token type.
+ * @return A string representing the token type.
+ */
+inline std::string_view getTokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::KEYWORD :
+            return "KEYWORD";
+        case TokenType::LINE_COMMENT:
+            return "LINE_COMMENT";
+        case TokenType::BLOCK_COMMENT:
+            return "BLOCK_COMMENT";
+        case TokenType::STRING:
+            return "STRING";
+        case TokenType::CHAR:
+            return "CHAR";
+        case TokenType::IDENTIFIER:
+            return "IDENTIFIER";
+        case TokenType::ANNOTATION:
+            return "ANNOTATION";
+        case TokenType::NUMBER:
+            return "NUMBER";
+        case TokenType::HEX_NUMBER:
+            return "HEX_NUMBER";
+        case TokenType::BINARY_NUMBER:
+            return "BINARY_NUMBER";
+        case TokenType::OPERATOR:
+            return "OPERATOR";
+        case TokenType::SYMBOL:
+            return "SYMBOL";
+        case TokenType::WHITESPACE:
+            return "WHITESPACE";
+        case TokenType::CONTEXTUAL_KEYWORD:
+            return "CONTEXTUAL_KEYWORD";
+        case TokenType::TEXT_BLOCK:
+            return "TEXT_BLOCK";
+        case TokenType::UNKNOWN:
+            return "UNKNOWN";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * Class representing a token whose lexeme points into the source buffer.
+ * Produced by `tokenize_view`; the source must outlive the token.
+ */
+class TokenView {
+public:
+    TokenType type;           // The type of the token.
+    NumberKind numberKind = NumberKind::NONE; // Type of `number`, if lexed with `LexOptions::parseNumbers`.
+    bool numberOverflow = false;              // True if the literal is out of the range of its type.
+    std::string_view lexeme;  // The text of the token, a view into the source code.
+    struct Position position; // The position of the token in the source code.
+    uint32_t id = no_identifier_id; // ID of the identifier or contextual keyword, if lexed with an `IdentifierInterner`.
+    NumberValue number{};           // Value of a number token, if lexed with `LexOptions::parseNumbers`.
+
+    TokenView(
+            TokenType type,
+            std::string_view lex,
+            struct Position position,
+            int indexOffset
+    ) : type(type),
+        lexeme(lex),
+        position(position) {
+        this->position.index -= (int) indexOffset;
+    }
+
+    friend std::ostream &operator<<(std::ostream &strm, const TokenView &token) {
+        return strm << "Token{Type: " << getTokenTypeName(token.type)
+                    << ", Position: " << token.position.line
+                    << ":" << token.position.column
+                    << ", Lexeme: '" << token.lexeme
+                    << "'}";
+    }
+};
+
 /**
  * Class representing a token produced by the lexer.
  */
 class Token {
 public:
     TokenType type;           // The type of the token.
+    NumberKind numberKind = NumberKind::NONE; // Type of `number`, if lexed with `LexOptions::parseNumbers`.
+    bool numberOverflow = false;              // True if the literal is out of the range of its type.
     std::string lexeme;       // The actual text of the token.
     struct Position position; // The position of the token in the source code.
+    uint32_t id = no_identifier_id; // ID of the identifier or contextual keyword, if lexed with an `IdentifierInterner`.
+    NumberValue number{};           // Value of a number token, if lexed with `LexOptions::parseNumbers`.
 
     Token(
             TokenType type,
@@ -60,41 +187,24 @@ public:
         lexeme(std::move(lex)),
         position({-1}) {}
 
+    /**
+     * Creates an owned copy of a token produced by `tokenize_view`.
+     * @param view - The token whose lexeme is copied out of the source buffer.
+     */
+    explicit Token(const TokenView &view) : type(view.type),
+                                            numberKind(view.numberKind),
+                                            numberOverflow(view.numberOverflow),
+                                            lexeme(view.lexeme),
+                                            position(view.position),
+                                            id(view.id),
+                                            number(view.number) {}
+
     /**
      * Returns the name of the token type as a string.
      * @return A string representing the token type.
      */
     [[nodiscard]] std::string getTokenTypeName() const {
-        switch (type) {
-            case TokenType::KEYWORD :
-                return "KEYWORD";
-            case TokenType::LINE_COMMENT:
-                return "LINE_COMMENT";
-            case TokenType::BLOCK_COMMENT:
-                return "BLOCK_COMMENT";
-            case TokenType::STRING:
-                return "STRING";
-            case TokenType::CHAR:
-                return "CHAR";
-            case TokenType::IDENTIFIER:
-                return "IDENTIFIER";
-            case TokenType::ANNOTATION:
-                return "ANNOTATION";
-            case TokenType::NUMBER:
-                return "NUMBER";
-            case TokenType::HEX_NUMBER:
-                return "HEX_NUMBER";
-            case TokenType::BINARY_NUMBER:
-                return "BINARY_NUMBER";
-            case TokenType::OPERATOR:
-                return "OPERATOR";
-            case TokenType::SYMBOL:
-                return "SYMBOL";
-            case TokenType::WHITESPACE:
-                return "WHITESPACE";
-            case TokenType::UNKNOWN:
-                return "UNKNOWN";
-        }
+        return std::string(::getTokenTypeName(type));
     }
 
     friend std::ostream &operator<<(std::ostream &strm, const Token &token) {
@@ -0,0 +1,292 @@
+#ifndef SIMPLEJAVALEXER_TOKEN_BUFFER_H
+#define SIMPLEJAVALEXER_TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "token.h"
+#include "line_index.h"
+
+/**
+ * Forward iterator yielding the tokens of a `TokenBuffer` or `TokenBufferView` as `TokenView` values.
+ */
+template<typename Buffer>
+class TokenBufferIterator {
+public:
+    using value_type = TokenView;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    TokenBufferIterator() = default;
+
+    TokenBufferIterator(const Buffer *buffer, size_t index) : buffer(buffer), index(index) {}
+
+    TokenView operator*() const {
+        return buffer->view(index);
+    }
+
+    TokenBufferIterator &operator++() {
+        index++;
+        return *this;
+    }
+
+    TokenBufferIterator operator++(int) {
+        TokenBufferIterator copy = *this;
+        index++;
+        return copy;
+    }
+
+    bool operator==(const TokenBufferIterator &other) const {
+        return index == other.index;
+    }
+
+private:
+    const Buffer *buffer = nullptr;
+    size_t index = 0;
+};
+
+/**
+ * A compact container of the tokens of one source.
+ *
+ * Tokens are stored as parallel arrays of a 1-byte type, a 4-byte offset and a 4-byte length,
+ * 9 bytes per token instead of the 50+ bytes of a `Token` and its heap-allocated lexeme.
+ * Lexemes are views into the source, which must outlive the buffer, and the line and column
+ * of a token are only computed when they are asked for, from a `LineIndex` of the source.
+ * Sources must be smaller than 4 GiB.
+ */
+class TokenBuffer {
+public:
+    using iterator = TokenBufferIterator<TokenBuffer>;
+
+    TokenBuffer() = default;
+
+    /**
+     * Creates an empty buffer for the tokens of the given source.
+     * @param source - The Java source code; must outlive the buffer.
+     */
+    explicit TokenBuffer(std::string_view source);
+
+    /**
+     * Copies the tokens of a view, e.g. of a mapped token stream, into a buffer that owns them.
+     * @param tokens - The tokens to copy; their source must outlive the buffer.
+     */
+    explicit TokenBuffer(const class TokenBufferView &tokens);
+
+    /**
+     * Appends a token of this buffer's source.
+     * @param token - The token; its position index must be the offset of its lexeme in the source.
+     */
+    void push_back(const TokenView &token) {
+        types.push_back((uint8_t) token.type);
+        offsets.push_back((uint32_t) token.position.index);
+        lengths.push_back((uint32_t) token.lexeme.size());
+    }
+
+    /**
+     * Requests capacity for at least `count` tokens.
+     */
+    void reserve(size_t count);
+
+    /**
+     * Releases unused capacity.
+     */
+    void shrink_to_fit();
+
+    /**
+     * Returns the number of tokens.
+     */
+    [[nodiscard]] size_t size() const {
+        return types.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return types.empty();
+    }
+
+    [[nodiscard]] TokenType type(size_t index) const {
+        return (TokenType) types[index];
+    }
+
+    [[nodiscard]] uint32_t offset(size_t index) const {
+        return offsets[index];
+    }
+
+    [[nodiscard]] std::string_view lexeme(size_t index) const {
+        return source.substr(offsets[index], lengths[index]);
+    }
+
+    /**
+     * Computes the position of a token from the line index.
+     */
+    [[nodiscard]] struct Position position(size_t index) const {
+        return lines.position(offsets[index]);
+    }
+
+    /**
+     * Returns a token as a view into the source.
+     */
+    [[nodiscard]] TokenView view(size_t index) const {
+        return {type(index), lexeme(index), position(index), 0};
+    }
+
+    /**
+     * Returns a token as an owned `Token`, as produced by `tokenize`.
+     */
+    [[nodiscard]] Token token(size_t index) const {
+        return Token(view(index));
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] iterator end() const {
+        return {this, size()};
+    }
+
+    /**
+     * Returns the source the tokens point into.
+     */
+    [[nodiscard]] std::string_view getSource() const {
+        return source;
+    }
+
+    /**
+     * Returns the number of bytes allocated by the buffer, including the line index.
+     */
+    [[nodiscard]] size_t memoryUsage() const;
+
+private:
+    friend class IncrementalLexer;
+    friend class TokenCache;
+    friend class TokenBufferView;
+
+    std::string_view source;        // The source the tokens point into.
+    LineIndex lines;                // Line starts of `source`.
+    std::vector<uint8_t> types;     // The `TokenType` of every token.
+    std::vector<uint32_t> offsets;  // Offset of every lexeme in `source`.
+    std::vector<uint32_t> lengths;  // Length of every lexeme.
+};
+
+/**
+ * A read-only view of the tokens of one source, with the same accessors as `TokenBuffer`,
+ * over arrays that it does not own: those of a `TokenBuffer`, or those of a token stream
+ * mapped from disk (see `token_stream.h`), which are used in place without any copy.
+ *
+ * Like `std::string_view`, a view is cheap to copy and must not outlive its arrays or the source.
+ */
+class TokenBufferView {
+public:
+    using iterator = TokenBufferIterator<TokenBufferView>;
+
+    TokenBufferView() = default;
+
+    /**
+     * Views the tokens of a buffer.
+     */
+    TokenBufferView(const TokenBuffer &buffer) // NOLINT(google-explicit-constructor)
+            : source(buffer.source),
+              lineStarts(buffer.lines.starts()),
+              types(buffer.types),
+              offsets(buffer.offsets),
+              lengths(buffer.lengths) {}
+
+    /**
+     * Views tokens stored as separate arrays.
+     * @param source - The source the tokens point into.
+     * @param lineStarts - Offset of the first character of every line of `source`.
+     * @param types - The `TokenType` of every token.
+     * @param offsets - Offset of every lexeme in `source`; same size as `types`.
+     * @param lengths - Length of every lexeme; same size as `types`.
+     */
+    TokenBufferView(std::string_view source, std::span<const uint32_t> lineStarts, std::span<const uint8_t> types,
+                    std::span<const uint32_t> offsets, std::span<const uint32_t> lengths)
+            : source(source), lineStarts(lineStarts), types(types), offsets(offsets), lengths(lengths) {}
+
+    [[nodiscard]] size_t size() const {
+        return types.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return types.empty();
+    }
+
+    [[nodiscard]] TokenType type(size_t index) const {
+        return (TokenType) types[index];
+    }
+
+    [[nodiscard]] uint32_t offset(size_t index) const {
+        return offsets[index];
+    }
+
+    [[nodiscard]] uint32_t length(size_t index) const {
+        return lengths[index];
+    }
+
+    [[nodiscard]] std::string_view lexeme(size_t index) const {
+        return source.substr(offsets[index], lengths[index]);
+    }
+
+    /**
+     * Computes the position of a token from the line starts.
+     */
+    [[nodiscard]] struct Position position(size_t index) const {
+        return positionInLines(lineStarts, offsets[index]);
+    }
+
+    /**
+     * Returns a token as a view into the source.
+     */
+    [[nodiscard]] TokenView view(size_t index) const {
+        return {type(index), lexeme(index), position(index), 0};
+    }
+
+    /**
+     * Returns a token as an owned `Token`, as produced by `tokenize`.
+     */
+    [[nodiscard]] Token token(size_t index) const {
+        return Token(view(index));
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] iterator end() const {
+        return {this, size()};
+    }
+
+    [[nodiscard]] std::string_view getSource() const {
+        return source;
+    }
+
+    /**
+     * Returns the line starts of the source.
+     */
+    [[nodiscard]] std::span<const uint32_t> getLineStarts() const {
+        return lineStarts;
+    }
+
+private:
+    friend class TokenBuffer;
+    friend void writeTokenStream(const TokenBufferView &tokens, std::ostream &out);
+
+    std::string_view source;               // The source the tokens point into.
+    std::span<const uint32_t> lineStarts;  // Offset of the first character of every line.
+    std::span<const uint8_t> types;        // The `TokenType` of every token.
+    std::span<const uint32_t> offsets;     // Offset of every lexeme in `source`.
+    std::span<const uint32_t> lengths;     // Length of every lexeme.
+};
+
+/**
+ * Tokenizes the given Java source code into a compact `TokenBuffer`.
+ * @param source - The Java source code; must outlive the buffer.
+ * @return A buffer holding the same tokens `tokenize_view` would produce.
+ */
+TokenBuffer tokenizeCompact(std::string_view source);
+
+#endif //SIMPLEJAVALEXER_TOKEN_BUFFER_H
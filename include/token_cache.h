@@ -0,0 +1,99 @@
+#ifndef SIMPLEJAVALEXER_TOKEN_CACHE_H
+#define SIMPLEJAVALEXER_TOKEN_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "token_buffer.h"
+
+/**
+ * Options for a `TokenCache`.
+ */
+struct TokenCacheOptions {
+    size_t capacity = 1024;  // Maximum number of sources whose tokens are kept in memory.
+    std::string directory;   // Directory of the on-disk store; empty keeps entries in memory only.
+};
+
+/**
+ * Counts of how `TokenCache::tokenize` calls were served.
+ */
+struct TokenCacheStats {
+    size_t hits = 0;      // Served from memory.
+    size_t diskHits = 0;  // Loaded from the on-disk store.
+    size_t misses = 0;    // Lexed.
+};
+
+/**
+ * A cache of the tokens of sources that are lexed again and again, e.g. vendored or generated
+ * files in every build.
+ *
+ * Entries are keyed by the XXH64 hash (see `contentHash`) and the size of the source, so a
+ * hit costs one pass of hashing, which is several times faster than lexing, and a copy of
+ * the compact token arrays of a `TokenBuffer`. The most recently used entries are kept in
+ * memory; with a directory, entries are also written to disk as token streams (see
+ * `token_stream.h`), one file per source, and mapped from there by later processes. The disk
+ * store is best effort: an entry that cannot be written, read or validated is treated as a miss.
+ *
+ * The cache is thread-safe; lexing runs outside the lock, so concurrent misses do not wait
+ * for each other.
+ */
+class TokenCache {
+public:
+    /**
+     * Creates an empty cache.
+     * @param options - The size of the in-memory cache and where to store entries on disk.
+     */
+    explicit TokenCache(TokenCacheOptions options = {});
+
+    TokenCache(const TokenCache &) = delete;
+
+    TokenCache &operator=(const TokenCache &) = delete;
+
+    /**
+     * Returns the tokens of a source, lexing it only if it is not cached.
+     * @param source - The Java source code; must outlive the returned buffer.
+     * @return The tokens `tokenizeCompact` would produce, pointing into `source`.
+     */
+    TokenBuffer tokenize(std::string_view source);
+
+    /**
+     * Returns how the calls so far were served.
+     */
+    [[nodiscard]] TokenCacheStats stats() const;
+
+    /**
+     * Drops all in-memory entries; the on-disk store is kept.
+     */
+    void clear();
+
+private:
+    /**
+     * The tokens of one source, with types, offsets, lengths and line index but no source.
+     */
+    struct Entry {
+        uint64_t hash;       // Content hash of the source.
+        size_t sourceSize;   // Size of the source in bytes.
+        TokenBuffer tokens;  // Tokens of the source.
+    };
+
+    TokenCacheOptions options;
+    mutable std::mutex mutex;                                         // Guards all members below.
+    std::list<Entry> entries;                                         // Most recently used first.
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;  // Entries by hash.
+    TokenCacheStats counters;
+
+    void insert(uint64_t hash, std::string_view source, const TokenBuffer &tokens);
+
+    [[nodiscard]] std::string entryPath(uint64_t hash) const;
+
+    [[nodiscard]] std::optional<TokenBuffer> load(uint64_t hash, std::string_view source) const;
+
+    void store(uint64_t hash, const TokenBuffer &tokens) const;
+};
+
+#endif //SIMPLEJAVALEXER_TOKEN_CACHE_H
@@ -1,65 +1,159 @@
 #ifndef SIMPLEJAVALEXER_TOKEN_MATCHER_H
 #define SIMPLEJAVALEXER_TOKEN_MATCHER_H
 
+#include <array>
 #include <iostream>
+#include <string_view>
+#include "token.h"
+#include "char_class.h"
+
+/**
+ * The words classified as `KEYWORD`, shared by the matchers below and the DFA engine (see `dfa_lexer.h`).
+ * https://en.wikipedia.org/wiki/List_of_Java_keywords
+ */
+inline constexpr std::array<std::string_view, 55> java_keywords = {
+        "abstract", "assert", "boolean", "break",
+        "byte", "case", "catch", "char", "class",
+        "continue", "default", "do", "double",
+        "else", "enum", "extends", "final", "if",
+        "finally", "float", "for", "implements",
+        "import", "instanceof", "int", "interface",
+        "long", "native", "new", "package", "private",
+        "protected", "public", "return", "short",
+        "static", "super", "switch", "synchronized",
+        "this", "throw", "throws", "transient", "try",
+        "void", "volatile", "while", "goto", "@interface",
+        "true", "false", "null", "const", "strictfp", "_"
+};
+
+/**
+ * The words classified as `CONTEXTUAL_KEYWORD`: restricted identifiers and contextual keywords, which are
+ * keywords only where the grammar expects them and identifiers everywhere else. `non-sealed` is a single
+ * token rather than `non`, `-` and `sealed` (see `nonSealedSuffixLength`).
+ */
+inline constexpr std::array<std::string_view, 6> java_contextual_keywords = {
+        "non-sealed", "permits", "record", "sealed", "var", "yield"
+};
+
+/**
+ * The lexemes classified as `OPERATOR`.
+ */
+inline constexpr std::array<std::string_view, 34> java_operators = {
+        "<", ">", ">=", "<=",
+        "<<", ">>", "<<=", ">>=",
+        "+", "+=", "++",
+        "-", "-=", "--",
+        "&", "&=", "&&",
+        "|", "|=", "||",
+        "=", "==",
+        "*", "*=",
+        "/", "/=",
+        "%", "%=",
+        "~", "~=",
+        "!", "!=",
+        "^", "^=",
+};
+
+/**
+ * The lexemes classified as `SYMBOL`.
+ */
+inline constexpr std::array<std::string_view, 13> java_symbols = {
+        ";", "->", "{", "}", "[", "]", "(", ")", ",", "@", ".", "?", ":"
+};
 
 /**
  * Checks if the given token is a Java keyword.
  * @param token - The string to check.
  * @return true if the token is a valid Java keyword; false otherwise.
  */
-bool isKeyword(const std::string &token);
+bool isKeyword(std::string_view token);
+
+/**
+ * Checks if the given token is a contextual keyword (see `java_contextual_keywords`).
+ * @param token - The string to check.
+ * @return true if the token is a contextual keyword; false otherwise.
+ */
+bool isContextualKeyword(std::string_view token);
+
+/**
+ * Classifies a word the lexer has read as an identifier, with a single lookup in one table
+ * of the strict and contextual keywords.
+ * @param word - A valid Java identifier, or `non-sealed`.
+ * @return `KEYWORD`, `CONTEXTUAL_KEYWORD` or `IDENTIFIER`.
+ */
+TokenType getWordType(std::string_view word);
+
+/**
+ * Checks if a word the lexer has emitted gets an ID from an `IdentifierInterner`: identifiers and
+ * the contextual keywords that are valid identifiers, i.e. all except `non-sealed`.
+ * @param type - The type of the token.
+ * @param lexeme - The text of the token.
+ * @return true if the token is interned; false otherwise.
+ */
+inline bool isInternedWord(TokenType type, std::string_view lexeme) {
+    return type == TokenType::IDENTIFIER || (type == TokenType::CONTEXTUAL_KEYWORD && lexeme != "non-sealed");
+}
+
+/**
+ * Measures the "-sealed" that turns the word `non` into the contextual keyword `non-sealed`.
+ * @param text - The text to scan.
+ * @param index - Index of the character after `non`.
+ * @return 7 if `text` continues with "-sealed" and no identifier character follows it; 0 otherwise.
+ */
+size_t nonSealedSuffixLength(std::string_view text, size_t index);
 
 /**
  * Checks if the given token is a Java operator.
  * @param token - The string to check.
  * @return true if the token is a valid Java operator; false otherwise.
  */
-bool isOperator(const std::string &token);
+bool isOperator(std::string_view token);
 
 /**
  * Checks if the given token is a Java symbol (e.g., semicolons, braces, etc.).
  * @param token - The string to check.
  * @return true if the token is a valid Java symbol; false otherwise.
  */
-bool isSymbol(const std::string &token);
+bool isSymbol(std::string_view token);
 
 /**
- * Checks if the given token is a valid identifier character in Java (letters, digits, '_', or '$').
+ * Checks if the given token is a single identifier character in Java (letters, digits, '_', or '$'),
+ * including non-ASCII characters in UTF-8 and Unicode escapes (see `unicode.h`).
  * @param token - The string to check.
  * @return true if the token matches the rules for an identifier character; false otherwise.
  */
-bool isIdentifierLetter(const std::string &token);
+bool isIdentifierLetter(std::string_view token);
 
 
 /**
  * Checks if the given token is a valid Java identifier.
- * A valid identifier starts with a letter, '_' or '$', and can be followed by letters, digits, '_' or '$'.
+ * A valid identifier starts with a letter, '_' or '$', and can be followed by letters, digits, '_' or '$',
+ * where letters and digits may be any Unicode ones, in UTF-8 or as Unicode escapes (see `unicode.h`).
  * @param token - The string to check.
  * @return true if the token matches the rules for a valid Java identifier; false otherwise.
  */
-bool isIdentifier(const std::string &token);
+bool isIdentifier(std::string_view token);
 
 /**
  * Checks if the given token consists of whitespace characters (spaces, tabs, etc.).
  * @param token - The string to check.
  * @return true if the token contains only whitespace characters; false otherwise.
  */
-bool isWhitespace(const std::string &token);
+bool isWhitespace(std::string_view token);
 
 /**
  * Checks if the given token starts with a character that could initiate a Java operator.
  * @param token - The string to check.
  * @return true if the first character of the token matches a potential operator starter; false otherwise.
  */
-bool isOperatorStart(const std::string &token);
+bool isOperatorStart(std::string_view token);
 
 /**
  * Determines the type of the given token based on Java syntax rules.
  * @param token - The string to classify.
  * @return The token's type as a `TokenType` enum value (e.g.,
- *  KEYWORD, OPERATOR, IDENTIFIER, WHITESPACE, SYMBOL, ANNOTATION, or UNKNOWN).
+ *  KEYWORD, CONTEXTUAL_KEYWORD, OPERATOR, IDENTIFIER, WHITESPACE, SYMBOL, ANNOTATION, or UNKNOWN).
  */
-TokenType getTokenType(const std::string &token);
+TokenType getTokenType(std::string_view token);
 
 #endif //SIMPLEJAVALEXER_TOKEN_MATCHER_H
@@ -0,0 +1,101 @@
+#ifndef SIMPLEJAVALEXER_TOKEN_STREAM_H
+#define SIMPLEJAVALEXER_TOKEN_STREAM_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "source_file.h"
+#include "token_buffer.h"
+
+/**
+ * A binary format for the tokens of one source, which can be used in place after mapping it.
+ *
+ * A token stream is a fixed header followed by four arrays, each starting at an offset that
+ * is a multiple of 4 bytes:
+ * ```
+ * TokenStreamHeader                   48 bytes
+ * uint32_t offsets[tokenCount]        offset of every lexeme in the source
+ * uint32_t lengths[tokenCount]        length of every lexeme
+ * uint32_t lineStarts[lineCount]      offset of the first character of every line
+ * uint8_t  types[tokenCount]          the TokenType of every token
+ * ```
+ * All integers are stored in the byte order of the writer, which is recorded in the header; a
+ * reader only accepts streams of its own byte order and version. The source itself is not part
+ * of the stream, but its size and `contentHash` are, so a reader can check that it is given
+ * the source the tokens were lexed from.
+ *
+ * Reading a stream only validates the header and its sizes: the arrays are used directly as
+ * a `TokenBufferView`, without any per-token work.
+ */
+struct TokenStreamHeader {
+    char magic[4];        // "SJLT".
+    uint16_t version;     // `token_stream_version` of the writer.
+    uint16_t byteOrder;   // 0x0102 as written by the writer.
+    uint32_t headerSize;  // Size of this header, for forward compatibility.
+    uint32_t reserved;    // Always 0.
+    uint64_t sourceSize;  // Size of the source in bytes.
+    uint64_t sourceHash;  // `contentHash` of the source.
+    uint64_t tokenCount;  // Number of tokens.
+    uint64_t lineCount;   // Number of lines.
+};
+
+/**
+ * The version of the token stream format, incremented on every incompatible change.
+ */
+inline constexpr uint16_t token_stream_version = 3;
+
+/**
+ * Writes tokens as a token stream.
+ * @param tokens - The tokens of a source, e.g. a `TokenBuffer`.
+ * @param out - The binary stream to write to.
+ */
+void writeTokenStream(const TokenBufferView &tokens, std::ostream &out);
+
+/**
+ * Writes tokens as a token stream file.
+ * @param tokens - The tokens of a source, e.g. a `TokenBuffer`.
+ * @param path - The path of the file to create or overwrite.
+ * @throws std::system_error if the file cannot be written.
+ */
+void saveTokenStream(const TokenBufferView &tokens, const std::string &path);
+
+/**
+ * Reads the header of a token stream.
+ * @param bytes - The token stream.
+ * @return The header.
+ * @throws std::runtime_error if the stream is not a token stream of this version and byte order.
+ */
+TokenStreamHeader readTokenStreamHeader(std::string_view bytes);
+
+/**
+ * Uses a token stream in place as the tokens of a source.
+ * @param bytes - The token stream; its start must be 4-byte aligned, and it must outlive the view.
+ * @param source - The source the tokens were lexed from; must outlive the view.
+ * @param checkTokens - Also check, in one pass over the arrays, that every token has a valid type and
+ *                      lies within `source`, and so does every line start; for streams that may be damaged.
+ * @return A view over the arrays of the stream.
+ * @throws std::runtime_error if the stream is invalid or truncated, or was written for a source of another size.
+ */
+TokenBufferView readTokenStream(std::string_view bytes, std::string_view source, bool checkTokens = false);
+
+/**
+ * A token stream file mapped into memory, together with the view of its tokens.
+ */
+struct MappedTokenStream {
+    SourceFile file;          // The mapped token stream.
+    TokenBufferView tokens;   // Tokens whose arrays are in `file` and whose lexemes point into the source.
+};
+
+/**
+ * Maps a token stream file and uses it in place as the tokens of a source.
+ * @param path - The path of the token stream file.
+ * @param source - The source the tokens were lexed from; must outlive the result.
+ * @param checkTokens - Also check every token and line start, as `readTokenStream` does.
+ * @return The mapping and the view of its tokens.
+ * @throws std::system_error if the file cannot be opened or read.
+ * @throws std::runtime_error if the file is not a valid token stream for `source`.
+ */
+MappedTokenStream loadTokenStream(const std::string &path, std::string_view source, bool checkTokens = false);
+
+#endif //SIMPLEJAVALEXER_TOKEN_STREAM_H
@@ -0,0 +1,100 @@
+#ifndef SIMPLEJAVALEXER_UNICODE_H
+#define SIMPLEJAVALEXER_UNICODE_H
+
+#include <cstddef>
+#include <string_view>
+#include "char_class.h"
+
+/**
+ * Non-ASCII identifier characters, in UTF-8 or as `\uXXXX` escapes.
+ *
+ * Java identifiers may contain any Unicode letter, digit, currency symbol, connector punctuation,
+ * combining mark or format character (see `Character.isJavaIdentifierPart`), written either
+ * directly in UTF-8 or as a Unicode escape. ASCII characters are classified by `char_class_table`
+ * as before, so the lexer only calls into this module for bytes with `CHAR_UNICODE_START`;
+ * everything else uses a two-level table generated from the Unicode character database by
+ * `tools/generate_unicode_table.py`, about 12 KiB in total.
+ *
+ * Escapes are recognized only where they form identifier characters and are not translated
+ * elsewhere: an escaped '"' never opens a string, and an escaped spelling of `if` is an identifier
+ * rather than the keyword. Columns still count bytes.
+ */
+
+/**
+ * A character decoded from the source.
+ */
+struct DecodedChar {
+    char32_t codePoint = 0;  // The Unicode code point.
+    size_t length = 0;       // Number of bytes of the encoded character; 0 if the bytes are invalid.
+};
+
+/**
+ * Checks if a byte may begin a non-ASCII character in UTF-8 or a Unicode escape.
+ */
+constexpr bool isUnicodeStart(char c) {
+    return hasCharClass(c, CHAR_UNICODE_START);
+}
+
+/**
+ * Checks if a code point can start a Java identifier (see `Character.isJavaIdentifierStart`).
+ * ASCII code points follow `isIdentifierStart`.
+ */
+bool isUnicodeIdentifierStart(char32_t codePoint);
+
+/**
+ * Checks if a code point can be part of a Java identifier (see `Character.isJavaIdentifierPart`).
+ * ASCII code points follow `isIdentifierLetter`.
+ */
+bool isUnicodeIdentifierPart(char32_t codePoint);
+
+/**
+ * Decodes the UTF-8 sequence at `index`, rejecting overlong forms, surrogates and code points above U+10FFFF.
+ * @param text - The text to decode from.
+ * @param index - Index of the first byte of the sequence.
+ * @return The character, or a length of 0 if the bytes at `index` are not a valid sequence.
+ */
+DecodedChar decodeUtf8(std::string_view text, size_t index);
+
+/**
+ * Decodes the Unicode escape at `index`: a '\', one or more 'u' and four hexadecimal digits.
+ * A high surrogate immediately followed by an escaped low surrogate decodes to one supplementary character.
+ * @param text - The text to decode from.
+ * @param index - Index of the '\'.
+ * @return The character, or a length of 0 if there is no escape at `index`.
+ */
+DecodedChar decodeUnicodeEscape(std::string_view text, size_t index);
+
+/**
+ * Measures the identifier character at `index`, in ASCII, UTF-8 or as a Unicode escape.
+ * @param text - The text to scan.
+ * @param index - Index of the first byte of the character.
+ * @param isStart - True if the character starts the identifier.
+ * @return The number of bytes of the character, or 0 if it is not an identifier character.
+ */
+size_t identifierCharLength(std::string_view text, size_t index, bool isStart);
+
+/**
+ * Skips the identifier characters that follow the start of an identifier.
+ * @param text - The text to scan.
+ * @param from - Index to start scanning at.
+ * @return The index of the first byte at or after `from` that does not continue the identifier.
+ */
+size_t skipIdentifierParts(std::string_view text, size_t from);
+
+/**
+ * Returns the length of the valid UTF-8 sequence at `index`, or 1 if there is none, so that
+ * a non-ASCII character that is not part of an identifier becomes one `UNKNOWN` token.
+ */
+size_t utf8SequenceLength(std::string_view text, size_t index);
+
+/**
+ * Returns how far `identifierCharLength` and `utf8SequenceLength` may read from `index`, for lexers
+ * that must wait for the rest of a chunked input (see `PushLexer`).
+ * @param text - The text available so far.
+ * @param index - Index of a byte with `CHAR_UNICODE_START`.
+ * @return The index after the last byte that may be read; greater than `text.size()` if the
+ *         escape at `index` may continue beyond the end of `text`.
+ */
+size_t unicodeLookahead(std::string_view text, size_t index);
+
+#endif //SIMPLEJAVALEXER_UNICODE_H
@@ -0,0 +1,452 @@
+#include "../include/async.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIMPLEJAVALEXER_HAS_PREAD 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>) && __has_include(<sys/syscall.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define SIMPLEJAVALEXER_HAS_IO_URING 1
+#endif
+#endif
+
+Executor::Executor(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&Executor::work, this);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void Executor::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard lock(mutex);
+        ready.push_back(handle);
+    }
+    wakeUp.notify_one();
+}
+
+void Executor::work() {
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (ready.empty()) {
+                return;
+            }
+            handle = ready.front();
+            ready.pop_front();
+        }
+        handle.resume();
+    }
+}
+
+/**
+ * A coroutine that starts at once and frees itself when it finishes, running a task of a group.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+/**
+ * Runs a task on an executor and reports its end to its group.
+ * The task is destroyed first, so nothing of it remains once the group sees it finish.
+ */
+DetachedTask runDetached(TaskGroup &group, Executor &executor, Task task) {
+    std::exception_ptr error;
+    {
+        Task running = std::move(task);
+        co_await executor.schedule();
+        try {
+            co_await running;
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    group.finish(error);
+}
+
+void TaskGroup::spawn(Task task) {
+    {
+        std::lock_guard lock(mutex);
+        running++;
+    }
+    runDetached(*this, executor, std::move(task));
+}
+
+void TaskGroup::wait() {
+    std::unique_lock lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+void TaskGroup::finish(std::exception_ptr taskError) {
+    // Notifying under the lock keeps the group alive until this returns, even once `wait` can return.
+    std::lock_guard lock(mutex);
+    if (taskError && !error) {
+        error = std::move(taskError);
+    }
+    if (--running == 0) {
+        done.notify_all();
+    }
+}
+
+#ifdef SIMPLEJAVALEXER_HAS_PREAD
+
+AsyncFile::AsyncFile(const std::string &path) {
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+    }
+}
+
+AsyncFile::~AsyncFile() {
+    close(fd);
+}
+
+/**
+ * Reads a block of a file with a blocking call.
+ * @return The number of bytes read, or the negated error number.
+ */
+long long readBlocking(int fd, void *, char *buffer, size_t size, uint64_t offset) {
+    ssize_t bytes;
+    do {
+        bytes = pread(fd, buffer, size, (off_t) offset);
+    } while (bytes < 0 && errno == EINTR);
+    return bytes < 0 ? -errno : bytes;
+}
+
+#else
+
+AsyncFile::AsyncFile(const std::string &path) {
+    stream = std::fopen(path.c_str(), "rb");
+    if (stream == nullptr) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+    }
+}
+
+AsyncFile::~AsyncFile() {
+    std::fclose((FILE *) stream);
+}
+
+/**
+ * Reads a block of a file with a blocking call. Seeking is safe, as a file has one read in flight at a time.
+ * @return The number of bytes read, or the negated error number.
+ */
+long long readBlocking(int, void *stream, char *buffer, size_t size, uint64_t offset) {
+    auto *file = (FILE *) stream;
+    if (std::fseek(file, (long) offset, SEEK_SET) != 0) {
+        return -EIO;
+    }
+    size_t bytes = std::fread(buffer, 1, size, file);
+    return bytes < size && std::ferror(file) ? -EIO : (long long) bytes;
+}
+
+#endif
+
+#ifdef SIMPLEJAVALEXER_HAS_IO_URING
+
+/**
+ * An io_uring driven through the raw system calls, so liburing is not needed.
+ * Submissions are serialized by a mutex; one thread reaps the completions.
+ */
+struct FileReader::Ring {
+    int fd = -1;
+    void *submissionRing = MAP_FAILED;
+    size_t submissionRingSize = 0;
+    void *completionRing = MAP_FAILED;
+    size_t completionRingSize = 0;
+    io_uring_sqe *entries = (io_uring_sqe *) MAP_FAILED;
+    size_t entriesSize = 0;
+    unsigned *submissionTail = nullptr;
+    unsigned *submissionMask = nullptr;
+    unsigned *submissionArray = nullptr;
+    unsigned *completionHead = nullptr;
+    unsigned *completionTail = nullptr;
+    unsigned *completionMask = nullptr;
+    io_uring_cqe *completions = nullptr;
+    std::mutex submitMutex;
+    // Orders a read before its completion in the C++ memory model, which does not see the ordering
+    // the kernel provides through the rings (nor does ThreadSanitizer).
+    std::atomic<uint64_t> submissions{0};
+
+    ~Ring() {
+        if (entries != MAP_FAILED) {
+            munmap(entries, entriesSize);
+        }
+        if (completionRing != MAP_FAILED && completionRing != submissionRing) {
+            munmap(completionRing, completionRingSize);
+        }
+        if (submissionRing != MAP_FAILED) {
+            munmap(submissionRing, submissionRingSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    /**
+     * Sets up a ring with room for `depth` submissions.
+     * @return The ring, or null if the kernel does not provide io_uring or reads through it.
+     */
+    static Ring *create(unsigned depth) {
+        io_uring_params params{};
+        int ringFd = (int) syscall(__NR_io_uring_setup, std::clamp(depth, 1u, 4096u), &params);
+        if (ringFd < 0) {
+            return nullptr;
+        }
+        auto *ring = new Ring;
+        ring->fd = ringFd;
+        // IORING_OP_READ arrived in Linux 5.6; fast polling, from 5.7, is the nearest feature flag.
+        if ((params.features & IORING_FEAT_FAST_POLL) == 0) {
+            delete ring;
+            return nullptr;
+        }
+
+        ring->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            ring->submissionRingSize = ring->completionRingSize =
+                    std::max(ring->submissionRingSize, ring->completionRingSize);
+        }
+        ring->submissionRing = mmap(nullptr, ring->submissionRingSize, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (ring->submissionRing == MAP_FAILED) {
+            delete ring;
+            return nullptr;
+        }
+        ring->completionRing = single ? ring->submissionRing :
+                               mmap(nullptr, ring->completionRingSize, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        ring->entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->entries = (io_uring_sqe *) mmap(nullptr, ring->entriesSize, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (ring->completionRing == MAP_FAILED || ring->entries == MAP_FAILED) {
+            delete ring;
+            return nullptr;
+        }
+
+        auto *submission = (char *) ring->submissionRing;
+        ring->submissionTail = (unsigned *) (submission + params.sq_off.tail);
+        ring->submissionMask = (unsigned *) (submission + params.sq_off.ring_mask);
+        ring->submissionArray = (unsigned *) (submission + params.sq_off.array);
+        auto *completion = (char *) ring->completionRing;
+        ring->completionHead = (unsigned *) (completion + params.cq_off.head);
+        ring->completionTail = (unsigned *) (completion + params.cq_off.tail);
+        ring->completionMask = (unsigned *) (completion + params.cq_off.ring_mask);
+        ring->completions = (io_uring_cqe *) (completion + params.cq_off.cqes);
+        return ring;
+    }
+
+    /**
+     * Queues one operation and submits it at once, so the submission queue never fills up.
+     * @return 0, or the error number if the operation could not be submitted.
+     */
+    int submit(uint8_t opcode, int fileFd, char *buffer, size_t size, uint64_t offset, uint64_t userData) {
+        std::lock_guard lock(submitMutex);
+        unsigned tail = *submissionTail;
+        unsigned index = tail & *submissionMask;
+        io_uring_sqe &entry = entries[index];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.opcode = opcode;
+        entry.fd = fileFd;
+        entry.addr = (uint64_t) (uintptr_t) buffer;
+        entry.len = (uint32_t) std::min<size_t>(size, UINT32_MAX);
+        entry.off = offset;
+        entry.user_data = userData;
+        submissionArray[index] = index;
+        __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+        submissions.fetch_add(1, std::memory_order_release);
+
+        long submitted;
+        do {
+            submitted = syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+        if (submitted < 0) {
+            // Without SQPOLL the kernel only takes entries during the call, so this one was not taken.
+            int error = errno;
+            __atomic_store_n(submissionTail, tail, __ATOMIC_RELEASE);
+            return error;
+        }
+        return 0;
+    }
+};
+
+#else
+
+struct FileReader::Ring {
+    static Ring *create(unsigned) {
+        return nullptr;
+    }
+};
+
+#endif
+
+FileReader::Read::Read(FileReader &reader, const AsyncFile &file, char *buffer, size_t size, uint64_t offset)
+        : reader(reader), file(file), buffer(buffer), size(size), offset(offset) {
+    reader.submit(*this);
+}
+
+FileReader::Read::~Read() {
+    // Only reached early if the awaiting coroutine unwinds; the buffer must outlive the read.
+    while (state.load(std::memory_order_acquire) != completed) {
+        std::this_thread::yield();
+    }
+}
+
+bool FileReader::Read::suspend(std::coroutine_handle<> awaiting) {
+    handle = awaiting;
+    int expected = started;
+    return state.compare_exchange_strong(expected, awaited, std::memory_order_acq_rel);
+}
+
+size_t FileReader::Read::bytesRead() const {
+    if (result < 0) {
+        throw std::system_error((int) -result, std::generic_category(), "Cannot read a source file");
+    }
+    return (size_t) result;
+}
+
+void FileReader::Read::complete(long long bytes) {
+    Executor &executor = reader.executor;
+    result = bytes;
+    // Once the state is `completed`, the read may be destroyed unless a coroutine awaits it.
+    if (state.exchange(completed, std::memory_order_acq_rel) == awaited) {
+        executor.post(handle);
+    }
+}
+
+FileReader::FileReader(Executor &executor, unsigned depth, bool useIoUring) : executor(executor) {
+    if (useIoUring) {
+        ring = Ring::create(depth);
+    }
+    if (ring != nullptr) {
+        threads.emplace_back(&FileReader::reapCompletions, this);
+        return;
+    }
+    unsigned count = std::clamp(depth, 1u, 8u);
+    for (unsigned i = 0; i < count; i++) {
+        threads.emplace_back(&FileReader::readOnThread, this);
+    }
+}
+
+FileReader::~FileReader() {
+#ifdef SIMPLEJAVALEXER_HAS_IO_URING
+    if (ring != nullptr) {
+        // A no-op without a read tells the reaping thread to stop; retried until it is submitted.
+        while (ring->submit(IORING_OP_NOP, -1, nullptr, 0, 0, 0) != 0) {
+            std::this_thread::yield();
+        }
+        threads.front().join();
+        delete ring;
+        return;
+    }
+#endif
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
+
+void FileReader::submit(Read &read) {
+#ifdef SIMPLEJAVALEXER_HAS_IO_URING
+    if (ring != nullptr) {
+        int error = ring->submit(IORING_OP_READ, read.file.fd, read.buffer, read.size, read.offset,
+                                 (uint64_t) (uintptr_t) &read);
+        if (error != 0) {
+            read.complete(-error);
+        }
+        return;
+    }
+#endif
+    {
+        std::lock_guard lock(mutex);
+        queued.push_back(&read);
+    }
+    wakeUp.notify_one();
+}
+
+void FileReader::readOnThread() {
+    while (true) {
+        Read *read;
+        {
+            std::unique_lock lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) {
+                return;
+            }
+            read = queued.front();
+            queued.pop_front();
+        }
+        read->complete(readBlocking(read->file.fd, read->file.stream, read->buffer, read->size, read->offset));
+    }
+}
+
+void FileReader::reapCompletions() {
+#ifdef SIMPLEJAVALEXER_HAS_IO_URING
+    bool stopped = false;
+    while (!stopped) {
+        syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        ring->submissions.load(std::memory_order_acquire);
+        unsigned head = *ring->completionHead;
+        unsigned tail = __atomic_load_n(ring->completionTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe &completion = ring->completions[head & *ring->completionMask];
+            if (completion.user_data == 0) {
+                stopped = true;
+            } else {
+                ((Read *) (uintptr_t) completion.user_data)->complete(completion.res);
+            }
+        }
+        __atomic_store_n(ring->completionHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+}
@@ -0,0 +1,152 @@
+#include "../include/batch_lexer.h"
+#include "../include/content_hash.h"
+#include "../include/lexer.h"
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+/**
+ * The tokens of the distinct lines one worker has lexed, for `BatchOptions::lineCacheSize`.
+ */
+struct LineCache {
+    struct LineHash {
+        size_t operator()(std::string_view line) const {
+            return contentHash(line);
+        }
+    };
+
+    /**
+     * The tokens of one line, a range of `tokens`.
+     */
+    struct Entry {
+        size_t first;        // Index of the first token.
+        size_t count;        // Number of tokens.
+        TokenType lastType;  // Type of the last token, if there is one.
+    };
+
+    using Lines = std::unordered_map<std::string_view, Entry, LineHash>;
+
+    // Cached lines by their bytes, including the newline. A line lexes differently depending on
+    // whether a whitespace at its start is merged (see `LexerSnapshot::mergesWhitespace`), so
+    // lines entered either way are kept apart.
+    Lines lines[2];
+    std::vector<TokenView> tokens;  // Tokens of all cached lines; positions are relative to their line start.
+    size_t size = 0;                // Number of cached lines.
+};
+
+/**
+ * Returns the state of the lexer at a line start outside of any token, given the token before it.
+ */
+LexerSnapshot lineEntry(size_t begin, int line, bool hasEmitted, TokenType lastType) {
+    return {
+            .state = STATE_NONE,
+            .position = {(int) begin, line, 1},
+            .wordStart = (int) begin,
+            .prev_c = begin == 0 ? '\0' : '\n',
+            .hasEmitted = hasEmitted,
+            .lastType = lastType,
+    };
+}
+
+/**
+ * Appends the cached tokens of a line to `tokens`, moved to the copy of the line at `begin`.
+ */
+void reuseLine(std::string_view line, std::string_view cached, const LineCache::Entry &entry,
+               const LineCache &cache, size_t begin, int lineNumber, std::vector<TokenView> &tokens) {
+    auto first = cache.tokens.begin() + (long) entry.first;
+    size_t copied = tokens.size();
+    tokens.insert(tokens.end(), first, first + (long) entry.count);
+    for (auto token = tokens.begin() + (long) copied; token != tokens.end(); ++token) {
+        token->lexeme = {line.data() + (token->lexeme.data() - cached.data()), token->lexeme.size()};
+        token->position.index += (int) begin;
+        token->position.line = lineNumber;
+    }
+}
+
+/**
+ * Tokenizes a source like `Lexer::drain`, reusing the tokens of the lines found in the cache
+ * and adding those of the other lines, while the cache has room.
+ */
+void lexWithLineCache(std::string_view source, const LexOptions &options, LineCache &cache, size_t capacity,
+                      std::vector<TokenView> &tokens) {
+    // Only runs of lines that are not found in the cache are lexed, each by a lexer of its own.
+    std::optional<Lexer> lexer;
+    LexerSnapshot start = lineEntry(0, 1, false, TokenType::UNKNOWN);  // State at `begin`.
+    size_t begin = 0;
+    int lineNumber = 1;
+    for (size_t newline = source.find('\n'); newline != std::string_view::npos;
+         newline = source.find('\n', begin)) {
+        std::string_view line = source.substr(begin, newline + 1 - begin);
+        bool isLineStart = start.state == STATE_NONE;
+        LineCache::Lines &lines = cache.lines[start.mergesWhitespace()];
+        auto cached = isLineStart ? lines.find(line) : lines.end();
+        if (cached != lines.end()) {
+            const LineCache::Entry &reused = cached->second;
+            reuseLine(line, cached->first, reused, cache, begin, lineNumber, tokens);
+            lexer.reset();
+            if (reused.count > 0) {
+                start = lineEntry(newline + 1, lineNumber + 1, true, reused.lastType);
+            } else {
+                start = lineEntry(newline + 1, lineNumber + 1, start.hasEmitted, start.lastType);
+            }
+        } else {
+            if (!lexer.has_value()) {
+                lexer.emplace(source, start, options);
+            }
+            size_t first = tokens.size();
+            lexer->drainUntil((int) (newline + 1), tokens);
+            start = lexer->snapshot();
+            if (isLineStart && start.state == STATE_NONE && cache.size < capacity) {
+                lines.emplace(line, LineCache::Entry{cache.tokens.size(), tokens.size() - first, start.lastType});
+                cache.size++;
+                for (size_t i = first; i < tokens.size(); i++) {
+                    cache.tokens.emplace_back(tokens[i]).position.index -= (int) begin;
+                }
+            }
+        }
+        begin = newline + 1;
+        lineNumber++;
+    }
+    if (!lexer.has_value()) {
+        if (begin == source.size()) {
+            return;
+        }
+        lexer.emplace(source, start, options);
+    }
+    lexer->drain(tokens);
+}
+
+/**
+ * Orders the sources largest first, so the biggest files start before everything else.
+ */
+std::vector<size_t> largestFirst(std::span<const std::string_view> sources) {
+    std::vector<size_t> order(sources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sources[a].size() > sources[b].size();
+    });
+    return order;
+}
+
+std::vector<std::vector<TokenView>> tokenizeAll(std::span<const std::string_view> sources,
+                                                const BatchOptions &options) {
+    ThreadPool &pool = options.pool != nullptr ? *options.pool : ThreadPool::shared();
+    std::vector<std::vector<TokenView>> results(sources.size());
+    std::vector<std::vector<TokenView>> scratch(pool.size());
+    std::vector<LineCache> caches(options.lineCacheSize > 0 ? pool.size() : 0);
+
+    std::vector<size_t> order = largestFirst(sources);
+    pool.run(order, [&](size_t file, unsigned worker) {
+        std::vector<TokenView> &tokens = scratch[worker];
+        tokens.clear();
+        LexOptions lexOptions{.interner = options.interner};
+        if (options.lineCacheSize > 0) {
+            lexWithLineCache(sources[file], lexOptions, caches[worker], options.lineCacheSize, tokens);
+        } else {
+            Lexer(sources[file], lexOptions).drain(tokens);
+        }
+        results[file].assign(tokens.begin(), tokens.end());
+    });
+    return results;
+}
@@ -0,0 +1,79 @@
+#include "../include/content_hash.h"
+#include <cstring>
+
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * Reads a little-endian integer from possibly unaligned memory.
+ */
+template<typename T>
+inline T readLittleEndian(const char *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = sizeof(T) == 8 ? (T) __builtin_bswap64(value) : (T) __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+inline uint64_t hashRound(uint64_t accumulator, uint64_t input) {
+    accumulator += input * prime2;
+    return rotateLeft(accumulator, 31) * prime1;
+}
+
+inline uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+    hash ^= hashRound(0, lane);
+    return hash * prime1 + prime4;
+}
+
+uint64_t contentHash(std::string_view data, uint64_t seed) {
+    const char *it = data.data();
+    const char *end = it + data.size();
+    uint64_t hash;
+
+    if (data.size() >= 32) {
+        uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+        for (; end - it >= 32; it += 32) {
+            for (int lane = 0; lane < 4; lane++) {
+                lanes[lane] = hashRound(lanes[lane], readLittleEndian<uint64_t>(it + lane * 8));
+            }
+        }
+        hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+               rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+        for (uint64_t lane: lanes) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = seed + prime5;
+    }
+    hash += data.size();
+
+    for (; end - it >= 8; it += 8) {
+        hash ^= hashRound(0, readLittleEndian<uint64_t>(it));
+        hash = rotateLeft(hash, 27) * prime1 + prime4;
+    }
+    if (end - it >= 4) {
+        hash ^= readLittleEndian<uint32_t>(it) * prime1;
+        hash = rotateLeft(hash, 23) * prime2 + prime3;
+        it += 4;
+    }
+    for (; it < end; it++) {
+        hash ^= (unsigned char) *it * prime5;
+        hash = rotateLeft(hash, 11) * prime1;
+    }
+
+    // Final avalanche.
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    return hash ^ (hash >> 32);
+}
@@ -0,0 +1,648 @@
+#include "../include/dfa_lexer.h"
+#include "../include/char_class.h"
+#include "../include/identifier_interner.h"
+#include "../include/number_helper.h"
+#include "../include/scan.h"
+#include "../include/token_matcher.h"
+#include "../include/unicode.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * What the lexer does with the longest match of the DFA, depending on the state it ends in.
+ */
+enum DfaAction : uint8_t {
+    DFA_REJECT,               // Not an accepting state: the match backs off to the last accepting one.
+    DFA_EMIT,                 // Emit the lexeme with the token type of the state.
+    DFA_EMIT_WORD,            // Emit a `KEYWORD`, a `CONTEXTUAL_KEYWORD` or an `IDENTIFIER`.
+    DFA_EMIT_AT_WORD,         // Emit a word that starts with '@', classified by `getTokenType`.
+    DFA_EMIT_BEFORE_NEWLINE,  // Emit the lexeme without its last character, the newline that ended it.
+    DFA_EMIT_UNCLOSED,        // Emit an unclosed block comment or text block as `UNKNOWN`, unless the source ends with a newline.
+    DFA_SKIP,                 // Drop whitespace that is merged into the previous `WHITESPACE` token.
+};
+
+/**
+ * Spans of bytes that leave a state unchanged, which the lexer skips with the vectorized scanners
+ * of `scan.h` instead of one transition per byte.
+ */
+enum DfaSpan : uint8_t {
+    DFA_NO_SPAN,
+    DFA_SPAN_LINE_COMMENT,   // Anything but a newline.
+    DFA_SPAN_BLOCK_COMMENT,  // Anything but a newline or a '/' after a '*'; a trailing '*' may close the comment.
+    DFA_SPAN_STRING,         // Anything but a '"' or a newline; a trailing '\' escapes the next byte.
+    DFA_SPAN_CHAR,           // Anything but a '\'' or a newline; a trailing '\' escapes the next byte.
+    DFA_SPAN_TEXT_BLOCK,     // The whole body of a text block, including the closing `"""`, which leads to `trailing`.
+    DFA_SPAN_BLANKS,         // Whitespace other than newlines.
+    DFA_SPAN_WORD,           // One non-ASCII identifier character or Unicode escape; the match ends before anything else.
+    DFA_SPAN_WORD_START,     // Like `DFA_SPAN_WORD`, but anything else is one `UNKNOWN` character.
+};
+
+inline constexpr size_t dfa_max_states = 256;  // State IDs are bytes.
+inline constexpr size_t dfa_max_classes = 64;
+inline constexpr uint8_t dfa_dead = 0;  // The state after the end of every token; unset transitions lead here.
+
+/**
+ * The DFA over all 256 bytes, as it is built, before bytes are merged into classes.
+ */
+struct DfaBuilder {
+    std::array<std::array<uint8_t, 256>, dfa_max_states> next{};  // Transitions of every state.
+    std::array<DfaAction, dfa_max_states> actions{};               // What a match ending in a state emits.
+    std::array<TokenType, dfa_max_states> types{};                 // Token type of `DFA_EMIT` states.
+    std::array<bool, dfa_max_states> spansLines{};                 // True if a match may contain a newline.
+    std::array<DfaSpan, dfa_max_states> spans{};                   // The span a state skips, if any.
+    std::array<uint8_t, dfa_max_states> trailing{};                // State after a span with a trailing '\' or '*', or a word character.
+    size_t stateCount = 1;                                         // State 0 is `dfa_dead`.
+
+    constexpr uint8_t add(DfaAction action, TokenType type = TokenType::UNKNOWN, bool spansLine = false) {
+        if (stateCount == dfa_max_states) {
+            throw "DfaBuilder: too many states";
+        }
+        actions[stateCount] = action;
+        types[stateCount] = type;
+        spansLines[stateCount] = spansLine;
+        return (uint8_t) stateCount++;
+    }
+
+    /**
+     * Sets the transition of `from` on every byte of `bytes`.
+     */
+    constexpr void on(uint8_t from, std::string_view bytes, uint8_t to) {
+        for (char c: bytes) {
+            next[from][(unsigned char) c] = to;
+        }
+    }
+
+    /**
+     * Sets the transition of `from` on every byte with one of the `CharClass` flags in `classes`.
+     */
+    constexpr void onClass(uint8_t from, uint8_t classes, uint8_t to) {
+        for (size_t c = 0; c < 256; c++) {
+            if ((char_class_table[c] & classes) != 0) {
+                next[from][c] = to;
+            }
+        }
+    }
+
+    /**
+     * Sets the transition of `from` on every byte that has none yet.
+     */
+    constexpr void otherwise(uint8_t from, uint8_t to) {
+        for (uint8_t &target: next[from]) {
+            if (target == dfa_dead) {
+                target = to;
+            }
+        }
+    }
+};
+
+/**
+ * The lexeme of an operator state: a word of up to three operator characters, or any longer word,
+ * which is never an operator or a symbol, identified by its last character.
+ */
+struct OperatorWord {
+    char chars[3]{};
+    size_t size = 0;    // 1 to 3, or 4 for a longer word ending in `chars[0]`.
+    uint8_t state = 0;  // The DFA state of the word.
+
+    [[nodiscard]] constexpr std::string_view text() const {
+        return {chars, std::min<size_t>(size, 3)};
+    }
+
+    [[nodiscard]] constexpr char back() const {
+        return size > 3 ? chars[0] : chars[size - 1];
+    }
+
+    [[nodiscard]] constexpr bool isSameWord(const OperatorWord &other) const {
+        return size == other.size && text() == other.text();
+    }
+
+    [[nodiscard]] constexpr OperatorWord append(char c) const {
+        OperatorWord word = *this;
+        if (size >= 3) {
+            return {{c}, 4};
+        }
+        word.chars[word.size++] = c;
+        return word;
+    }
+
+    /**
+     * Checks if `c` extends the word, following `Lexer::consumeOperator`.
+     */
+    [[nodiscard]] constexpr bool continuesWith(char c) const {
+        bool isClosed = size <= 3 && (text() == "->" || text() == "++" || text() == "--");
+        // A '/' only continues a lone '/', and "//" is a line comment, which `buildDfa` wires up.
+        bool isComment = c == '/' && back() == '/';
+        return !isClosed && !isComment && (c == '=' || c == back() || (back() == '-' && c == '>'));
+    }
+
+    /**
+     * Classifies the word like `getTokenType`.
+     */
+    [[nodiscard]] constexpr TokenType type() const {
+        if (size > 3) {
+            return TokenType::UNKNOWN;
+        } else if (std::find(java_operators.begin(), java_operators.end(), text()) != java_operators.end()) {
+            return TokenType::OPERATOR;
+        } else if (std::find(java_symbols.begin(), java_symbols.end(), text()) != java_symbols.end()) {
+            return TokenType::SYMBOL;
+        }
+        return TokenType::UNKNOWN;
+    }
+};
+
+/**
+ * Adds the states of every word the operator rules of the state machine can form, starting
+ * from the start states.
+ * @return The state of a lone '/', which comments also start with.
+ */
+constexpr uint8_t addOperators(DfaBuilder &dfa, std::array<uint8_t, 2> starts) {
+    std::array<OperatorWord, dfa_max_states> words{};
+    size_t count = 0;
+    auto stateOf = [&](OperatorWord word) {
+        for (size_t i = 0; i < count; i++) {
+            if (words[i].isSameWord(word)) {
+                return words[i].state;
+            }
+        }
+        word.state = dfa.add(DFA_EMIT, word.type());
+        words[count++] = word;
+        return word.state;
+    };
+
+    for (char c: java_operators_starter) {
+        uint8_t state = stateOf({{c}, 1});
+        for (uint8_t start: starts) {
+            dfa.on(start, {&c, 1}, state);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        OperatorWord word = words[i];
+        for (char c: java_operators_starter) {
+            if (word.continuesWith(c)) {
+                dfa.on(word.state, {&c, 1}, stateOf(word.append(c)));
+            }
+        }
+    }
+    return stateOf({{'/'}, 1});
+}
+
+/**
+ * Adds the states of a string or char literal, which the first unescaped `quote` closes
+ * and a newline ends as `UNKNOWN`.
+ * @return The state after the opening quote.
+ */
+constexpr uint8_t addLiteral(DfaBuilder &dfa, char quote, TokenType type, uint8_t newline) {
+    uint8_t body = dfa.add(DFA_EMIT, TokenType::UNKNOWN);     // Unclosed at the end of the source.
+    uint8_t escaped = dfa.add(DFA_EMIT, TokenType::UNKNOWN);  // After a '\'.
+    uint8_t closed = dfa.add(DFA_EMIT, type);
+    dfa.spans[body] = quote == '"' ? DFA_SPAN_STRING : DFA_SPAN_CHAR;
+    dfa.trailing[body] = escaped;
+    dfa.on(body, {&quote, 1}, closed);
+    for (uint8_t state: {body, escaped}) {
+        dfa.on(state, "\n", newline);
+        dfa.on(state, "\\", escaped);
+        dfa.otherwise(state, body);
+    }
+    return body;
+}
+
+/**
+ * Adds the states of the '"' and `""` that may open a text block, and of the text block itself.
+ * Any other byte after the '"' continues the string literal whose body is `string`.
+ * @return The state after a '"'.
+ */
+constexpr uint8_t addTextBlock(DfaBuilder &dfa, uint8_t string) {
+    uint8_t quote = dfa.add(DFA_EMIT, TokenType::UNKNOWN);
+    uint8_t emptyString = dfa.add(DFA_EMIT, TokenType::STRING);
+    uint8_t body = dfa.add(DFA_EMIT_UNCLOSED, TokenType::UNKNOWN, true);
+    uint8_t closed = dfa.add(DFA_EMIT, TokenType::TEXT_BLOCK, true);
+    dfa.next[quote] = dfa.next[string];
+    dfa.on(quote, "\"", emptyString);
+    dfa.on(emptyString, "\"", body);
+    dfa.spans[body] = DFA_SPAN_TEXT_BLOCK;
+    dfa.trailing[body] = closed;
+    return quote;
+}
+
+/**
+ * Adds the states of a hexadecimal or binary number.
+ * @param digits - The `CharClass` of the digits.
+ * @return The state after the "0x" or "0b" prefix.
+ */
+constexpr uint8_t addRadixNumber(DfaBuilder &dfa, uint8_t digits, TokenType type) {
+    uint8_t prefix = dfa.add(DFA_EMIT, TokenType::UNKNOWN);  // A prefix without digits is invalid.
+    uint8_t prefixSuffix = dfa.add(DFA_EMIT, TokenType::UNKNOWN);
+    uint8_t number = dfa.add(DFA_EMIT, type);
+    uint8_t underscores = dfa.add(DFA_REJECT);  // Only valid if a digit follows.
+    uint8_t suffix = dfa.add(DFA_EMIT, type);
+    dfa.onClass(prefix, digits, number);
+    dfa.on(prefix, "lL", prefixSuffix);
+    dfa.onClass(number, digits, number);
+    dfa.on(number, "_", underscores);
+    dfa.on(number, "lL", suffix);
+    dfa.on(underscores, "_", underscores);
+    dfa.onClass(underscores, digits, number);
+    return prefix;
+}
+
+/**
+ * The generated DFA, with bytes merged into equivalence classes.
+ */
+struct DfaTables {
+    std::array<uint8_t, 256> byteClass{};  // Equivalence class of every byte.
+    size_t classCount = 0;
+    size_t rowShift = 0;  // Rows are padded to a power of two, so a state is found with a shift.
+    size_t stateCount = 0;
+    uint8_t start = dfa_dead;         // Start state where the next whitespace is emitted as a token.
+    uint8_t startMerging = dfa_dead;  // Start state where the next whitespace is dropped.
+    uint8_t unknown = dfa_dead;       // State of an `UNKNOWN` character, after a failed `DFA_SPAN_WORD_START`.
+    std::array<uint8_t, dfa_max_states * dfa_max_classes> next{};  // One row of transitions per state.
+    std::array<DfaAction, dfa_max_states> actions{};
+    std::array<TokenType, dfa_max_states> types{};
+    std::array<bool, dfa_max_states> spansLines{};
+    std::array<DfaSpan, dfa_max_states> spans{};
+    std::array<uint8_t, dfa_max_states> trailing{};
+};
+
+/**
+ * Merges the bytes that every state treats alike into one class.
+ */
+constexpr DfaTables compressDfa(const DfaBuilder &dfa, uint8_t start, uint8_t startMerging, uint8_t unknown) {
+    DfaTables tables;
+    std::array<size_t, dfa_max_classes> representatives{};
+    for (size_t c = 0; c < 256; c++) {
+        size_t byteClass = 0;
+        while (byteClass < tables.classCount) {
+            size_t other = representatives[byteClass];
+            size_t state = 0;
+            while (state < dfa.stateCount && dfa.next[state][c] == dfa.next[state][other]) {
+                state++;
+            }
+            if (state == dfa.stateCount) {
+                break;
+            }
+            byteClass++;
+        }
+        if (byteClass == tables.classCount) {
+            if (byteClass == dfa_max_classes) {
+                throw "compressDfa: too many byte classes";
+            }
+            representatives[tables.classCount++] = c;
+        }
+        tables.byteClass[c] = (uint8_t) byteClass;
+    }
+
+    while ((size_t) 1 << tables.rowShift < tables.classCount) {
+        tables.rowShift++;
+    }
+    tables.stateCount = dfa.stateCount;
+    tables.start = start;
+    tables.startMerging = startMerging;
+    tables.unknown = unknown;
+    for (size_t state = 0; state < dfa.stateCount; state++) {
+        for (size_t byteClass = 0; byteClass < tables.classCount; byteClass++) {
+            tables.next[(state << tables.rowShift) + byteClass] = dfa.next[state][representatives[byteClass]];
+        }
+        tables.actions[state] = dfa.actions[state];
+        tables.types[state] = dfa.types[state];
+        tables.spansLines[state] = dfa.spansLines[state];
+        tables.spans[state] = dfa.spans[state];
+        tables.trailing[state] = dfa.trailing[state];
+    }
+    return tables;
+}
+
+/**
+ * Builds the DFA of the tokens of `Lexer`, one group of states per tokenizer state.
+ */
+constexpr DfaTables buildDfa() {
+    DfaBuilder dfa;
+    uint8_t start = dfa.add(DFA_REJECT);
+    uint8_t startMerging = dfa.add(DFA_REJECT);
+    std::array<uint8_t, 2> starts = {start, startMerging};
+
+    // Whitespace: the first character after another token is emitted, the rest is dropped.
+    uint8_t whitespace = dfa.add(DFA_EMIT, TokenType::WHITESPACE, true);
+    uint8_t merged = dfa.add(DFA_SKIP, TokenType::WHITESPACE, true);
+    dfa.onClass(start, CHAR_WHITESPACE, whitespace);
+    dfa.onClass(startMerging, CHAR_WHITESPACE, merged);
+    dfa.onClass(merged, CHAR_WHITESPACE, merged);
+    dfa.spans[merged] = DFA_SPAN_BLANKS;
+
+    // Words: identifiers, keywords and annotations. Non-ASCII characters and Unicode escapes are
+    // decoded by the word spans, which either match one identifier character or end the match.
+    uint8_t word = dfa.add(DFA_EMIT_WORD);
+    uint8_t at = dfa.add(DFA_EMIT, TokenType::SYMBOL);
+    uint8_t atWord = dfa.add(DFA_EMIT_AT_WORD);
+    uint8_t wordStartChar = dfa.add(DFA_REJECT);
+    uint8_t wordChar = dfa.add(DFA_REJECT);
+    uint8_t atWordChar = dfa.add(DFA_REJECT);
+    dfa.spans[wordStartChar] = DFA_SPAN_WORD_START;
+    dfa.spans[wordChar] = DFA_SPAN_WORD;
+    dfa.spans[atWordChar] = DFA_SPAN_WORD;
+    dfa.trailing[wordStartChar] = word;
+    dfa.trailing[wordChar] = word;
+    dfa.trailing[atWordChar] = atWord;
+    dfa.onClass(word, CHAR_IDENTIFIER_PART, word);
+    dfa.onClass(word, CHAR_UNICODE_START, wordChar);
+    dfa.onClass(at, CHAR_IDENTIFIER_PART, atWord);
+    dfa.onClass(at, CHAR_UNICODE_START, atWordChar);
+    dfa.onClass(atWord, CHAR_IDENTIFIER_PART, atWord);
+    dfa.onClass(atWord, CHAR_UNICODE_START, atWordChar);
+
+    // Symbols, including "::" and the '.' that may start a number.
+    uint8_t symbol = dfa.add(DFA_EMIT, TokenType::SYMBOL);
+    uint8_t colon = dfa.add(DFA_EMIT, TokenType::SYMBOL);
+    uint8_t dot = dfa.add(DFA_EMIT, TokenType::SYMBOL);
+    dfa.on(colon, ":", symbol);
+
+    // Comments. The '*' that opens a block comment may also be the one that closes it: "/*/".
+    uint8_t lineComment = dfa.add(DFA_EMIT, TokenType::LINE_COMMENT);
+    uint8_t lineCommentEnd = dfa.add(DFA_EMIT_BEFORE_NEWLINE, TokenType::LINE_COMMENT, true);
+    uint8_t blockComment = dfa.add(DFA_EMIT_UNCLOSED, TokenType::UNKNOWN, true);
+    uint8_t blockCommentStar = dfa.add(DFA_EMIT_UNCLOSED, TokenType::UNKNOWN, true);
+    uint8_t blockCommentEnd = dfa.add(DFA_EMIT, TokenType::BLOCK_COMMENT, true);
+    dfa.spans[lineComment] = DFA_SPAN_LINE_COMMENT;
+    dfa.spans[blockComment] = DFA_SPAN_BLOCK_COMMENT;
+    dfa.trailing[blockComment] = blockCommentStar;
+    dfa.on(lineComment, "\n", lineCommentEnd);
+    dfa.otherwise(lineComment, lineComment);
+    dfa.on(blockComment, "*", blockCommentStar);
+    dfa.otherwise(blockComment, blockComment);
+    dfa.on(blockCommentStar, "/", blockCommentEnd);
+    dfa.on(blockCommentStar, "*", blockCommentStar);
+    dfa.otherwise(blockCommentStar, blockComment);
+
+    // Literals.
+    uint8_t literalNewline = dfa.add(DFA_EMIT_BEFORE_NEWLINE, TokenType::UNKNOWN, true);
+    uint8_t string = addTextBlock(dfa, addLiteral(dfa, '"', TokenType::STRING, literalNewline));
+    uint8_t character = addLiteral(dfa, '\'', TokenType::CHAR, literalNewline);
+
+    // Decimal numbers, by whether they have a dot and an exponent. An underscore is only part of
+    // a number if a digit follows the run of underscores, and an 'e' only if a digit or a sign follows.
+    uint8_t digits[2][2], underscores[2][2];  // Indexed by whether there is a dot, then an exponent.
+    uint8_t dotted[2];                        // After the dot, indexed by whether there is an exponent.
+    uint8_t exponent[2], sign[2];             // After the 'e' and its sign, indexed by whether there is a dot.
+    for (int i = 0; i < 4; i++) {
+        digits[i / 2][i % 2] = dfa.add(DFA_EMIT, TokenType::NUMBER);
+        underscores[i / 2][i % 2] = dfa.add(DFA_REJECT);
+    }
+    for (int i = 0; i < 2; i++) {
+        dotted[i] = dfa.add(DFA_EMIT, TokenType::NUMBER);
+        exponent[i] = dfa.add(DFA_REJECT);
+        sign[i] = dfa.add(DFA_EMIT, TokenType::NUMBER);
+    }
+    uint8_t suffix = dfa.add(DFA_EMIT, TokenType::NUMBER);
+    for (int hasDot = 0; hasDot < 2; hasDot++) {
+        for (int hasE = 0; hasE < 2; hasE++) {
+            uint8_t state = digits[hasDot][hasE];
+            dfa.onClass(state, CHAR_DIGIT, state);
+            dfa.on(state, "_", underscores[hasDot][hasE]);
+            dfa.on(state, "fFdD", suffix);
+            if (!hasDot) {
+                dfa.on(state, ".", dotted[hasE]);
+            }
+            if (!hasE) {
+                dfa.on(state, "eE", exponent[hasDot]);
+            }
+            if (!hasDot && !hasE) {
+                dfa.on(state, "lL", suffix);
+            }
+            dfa.on(underscores[hasDot][hasE], "_", underscores[hasDot][hasE]);
+            dfa.onClass(underscores[hasDot][hasE], CHAR_DIGIT, state);
+        }
+    }
+    for (int hasE = 0; hasE < 2; hasE++) {
+        dfa.onClass(dotted[hasE], CHAR_DIGIT, digits[1][hasE]);
+        dfa.on(dotted[hasE], "fFdD", suffix);
+        if (!hasE) {
+            dfa.on(dotted[hasE], "eE", exponent[1]);
+        }
+    }
+    for (int hasDot = 0; hasDot < 2; hasDot++) {
+        dfa.onClass(exponent[hasDot], CHAR_DIGIT, digits[hasDot][1]);
+        dfa.on(exponent[hasDot], "+-", sign[hasDot]);
+        dfa.onClass(sign[hasDot], CHAR_DIGIT, digits[hasDot][1]);
+        dfa.on(sign[hasDot], "fFdD", suffix);
+        if (!hasDot) {
+            dfa.on(sign[hasDot], ".", dotted[1]);
+        }
+    }
+    dfa.onClass(dot, CHAR_DIGIT, digits[1][0]);
+
+    // A leading zero may also start a hexadecimal or binary number.
+    uint8_t zero = dfa.add(DFA_EMIT, TokenType::NUMBER);
+    dfa.next[zero] = dfa.next[digits[0][0]];
+    dfa.on(zero, "xX", addRadixNumber(dfa, CHAR_HEX_DIGIT, TokenType::HEX_NUMBER));
+    dfa.on(zero, "bB", addRadixNumber(dfa, CHAR_BINARY_DIGIT, TokenType::BINARY_NUMBER));
+
+    uint8_t slash = addOperators(dfa, starts);
+    dfa.on(slash, "/", lineComment);
+    dfa.on(slash, "*", blockCommentStar);
+
+    uint8_t unknown = dfa.add(DFA_EMIT, TokenType::UNKNOWN);
+    for (uint8_t state: starts) {
+        dfa.onClass(state, CHAR_IDENTIFIER_START, word);
+        dfa.onClass(state, CHAR_UNICODE_START, wordStartChar);
+        for (std::string_view lexeme: java_symbols) {
+            if (lexeme.size() == 1) {
+                dfa.on(state, lexeme, symbol);
+            }
+        }
+        dfa.on(state, "@", at);
+        dfa.on(state, ":", colon);
+        dfa.on(state, ".", dot);
+        dfa.onClass(state, CHAR_DIGIT, digits[0][0]);
+        dfa.on(state, "0", zero);
+        dfa.on(state, "\"", string);
+        dfa.on(state, "'", character);
+        dfa.otherwise(state, unknown);
+    }
+    return compressDfa(dfa, start, startMerging, unknown);
+}
+
+inline constexpr DfaTables dfa_tables = buildDfa();
+
+/**
+ * Checks that the first byte of every token is accepted, or starts a `DFA_SPAN_WORD_START`, which
+ * always matches, so a match is never empty.
+ */
+constexpr bool startsAreAccepting() {
+    for (uint8_t start: {dfa_tables.start, dfa_tables.startMerging}) {
+        for (size_t byteClass = 0; byteClass < dfa_tables.classCount; byteClass++) {
+            uint8_t state = dfa_tables.next[(start << dfa_tables.rowShift) + byteClass];
+            if (dfa_tables.actions[state] == DFA_REJECT && dfa_tables.spans[state] != DFA_SPAN_WORD_START) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(startsAreAccepting(), "Every byte must start a token");
+
+size_t dfaStateCount() {
+    return dfa_tables.stateCount;
+}
+
+size_t dfaByteClassCount() {
+    return dfa_tables.classCount;
+}
+
+/**
+ * Appends a token matched by the DFA, computing the same extra fields as `Lexer::emitAt`.
+ */
+void emitDfaToken(std::vector<TokenView> &tokens, TokenType type, std::string_view lexeme,
+                  struct Position position, const LexOptions &options) {
+    if ((options.emitTypes & tokenTypeBit(type)) == 0) {
+        return;
+    }
+    TokenView &token = tokens.emplace_back(type, lexeme, position, 0);
+    if (options.interner != nullptr && isInternedWord(type, lexeme)) {
+        token.id = options.interner->intern(lexeme);
+    } else if (options.parseNumbers && (type == TokenType::NUMBER || type == TokenType::HEX_NUMBER ||
+                                        type == TokenType::BINARY_NUMBER)) {
+        NumberLiteral literal = parseNumberLiteral(type, lexeme);
+        token.numberKind = literal.kind;
+        token.numberOverflow = literal.overflow;
+        token.number = literal.value;
+    }
+}
+
+/**
+ * Skips the span of bytes that leave a state unchanged, except for its last byte, or the
+ * character of a word span.
+ * @param from - Index of the first byte after the one that led to `state`.
+ * @param state - The state; updated if the last byte of the span changes it, and `dfa_dead`
+ *                if a `DFA_SPAN_WORD` does not match.
+ * @return The index of the first byte that is not part of the span.
+ */
+size_t skipDfaSpan(std::string_view source, size_t from, uint8_t &state) {
+    size_t end = from;
+    switch (dfa_tables.spans[state]) {
+        case DFA_NO_SPAN:
+            break;
+        case DFA_SPAN_LINE_COMMENT:
+            end = scanUntil(source, from, '\n', '\n');
+            break;
+        case DFA_SPAN_BLOCK_COMMENT:
+            end = scanBlockComment(source, from, source[from - 1]);
+            if (end > from && source[end - 1] == '*') {
+                state = dfa_tables.trailing[state];
+            }
+            break;
+        case DFA_SPAN_STRING:
+        case DFA_SPAN_CHAR:
+            end = scanUntil(source, from, dfa_tables.spans[state] == DFA_SPAN_STRING ? '"' : '\'', '\n');
+            if (end > from && source[end - 1] == '\\') {
+                state = dfa_tables.trailing[state];
+            }
+            break;
+        case DFA_SPAN_TEXT_BLOCK:
+            // Newlines are part of the span; the lines of the match are counted after it.
+            end = scanUntil(source, from, '"', '\\');
+            while (end < source.size()) {
+                if (source.substr(end, 3) == "\"\"\"") {
+                    state = dfa_tables.trailing[state];
+                    end += 3;
+                    break;
+                }
+                // A '\' escapes the next byte, which cannot start the closing `"""`.
+                end = scanUntil(source, std::min(end + (source[end] == '\\' ? 2 : 1), source.size()), '"', '\\');
+            }
+            break;
+        case DFA_SPAN_BLANKS:
+            end = skipBlanks(source, from);
+            break;
+        case DFA_SPAN_WORD:
+        case DFA_SPAN_WORD_START: {
+            // The span starts at the byte that led to `state` itself.
+            bool isStart = dfa_tables.spans[state] == DFA_SPAN_WORD_START;
+            size_t length = identifierCharLength(source, from - 1, isStart);
+            if (length > 0) {
+                state = dfa_tables.trailing[state];
+            } else if (isStart) {
+                state = dfa_tables.unknown;
+                length = utf8SequenceLength(source, from - 1);
+            } else {
+                state = dfa_dead;
+            }
+            end = from - 1 + length;
+            break;
+        }
+    }
+    return end;
+}
+
+void tokenizeDfa(std::string_view source, std::vector<TokenView> &tokens, const LexOptions &options) {
+    tokens.clear();
+    tokens.reserve(estimateTokenCount(source.size(), options.emitTypes));
+
+    const auto *bytes = (const unsigned char *) source.data();
+    size_t size = source.size();
+    int line = options.trackPositions ? 1 : 0;
+    size_t lineStart = 0;
+    bool mergesWhitespace = true;  // Whitespace at the start of the source is dropped.
+    size_t begin = 0;
+    while (begin < size) {
+        // Run to the dead state, remembering the last accepting state: the longest match.
+        uint8_t state = mergesWhitespace ? dfa_tables.startMerging : dfa_tables.start;
+        uint8_t accepted = dfa_dead;
+        size_t end = begin;
+        for (size_t index = begin; index < size; index++) {
+            state = dfa_tables.next[(state << dfa_tables.rowShift) + dfa_tables.byteClass[bytes[index]]];
+            if (state == dfa_dead) {
+                break;
+            }
+            if (dfa_tables.actions[state] != DFA_REJECT) {
+                accepted = state;
+                end = index + 1;
+            }
+            if (dfa_tables.spans[state] != DFA_NO_SPAN) {
+                // Every span ends in an accepting state, unless a word span does not match.
+                index = skipDfaSpan(source, index + 1, state) - 1;
+                if (state == dfa_dead) {
+                    break;
+                }
+                accepted = state;
+                end = index + 1;
+            }
+        }
+
+        DfaAction action = dfa_tables.actions[accepted];
+        TokenType type = dfa_tables.types[accepted];
+        std::string_view lexeme = source.substr(begin, end - begin);
+        if (action == DFA_EMIT_WORD) {
+            // Like `Lexer::consumeWord`, which reads on over the "-sealed" of `non-sealed`.
+            if (lexeme == "non") {
+                end += nonSealedSuffixLength(source, end);
+                lexeme = source.substr(begin, end - begin);
+            }
+            type = getWordType(lexeme);
+        } else if (action == DFA_EMIT_AT_WORD) {
+            type = getTokenType(lexeme);
+        } else if (action == DFA_EMIT_BEFORE_NEWLINE) {
+            lexeme.remove_suffix(1);
+        } else if (action == DFA_EMIT_UNCLOSED && bytes[end - 1] == '\n') {
+            // Like the state machine, which only finalizes a pending token after a character that is not a newline.
+            break;
+        }
+        if (action != DFA_SKIP) {
+            int column = options.trackPositions ? (int) (begin - lineStart) + 1 : 0;
+            emitDfaToken(tokens, type, lexeme, {(int) begin, line, column}, options);
+            mergesWhitespace = type == TokenType::WHITESPACE;
+        }
+
+        if (options.trackPositions && dfa_tables.spansLines[accepted]) {
+            const char *newline = source.data() + begin;
+            const char *matchEnd = source.data() + end;
+            while ((newline = (const char *) std::memchr(newline, '\n', matchEnd - newline)) != nullptr) {
+                line++;
+                lineStart = ++newline - source.data();
+            }
+        }
+        begin = end;
+    }
+}
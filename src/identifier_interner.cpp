@@ -0,0 +1,47 @@
+#include "../include/identifier_interner.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+IdentifierInterner::IdentifierInterner(size_t shardCount)
+        : shardCount(std::max<size_t>(shardCount, 1)),
+          shards(std::make_unique<Shard[]>(this->shardCount)) {}
+
+uint32_t IdentifierInterner::intern(std::string_view name) {
+    Key key = {name, std::hash<std::string_view>{}(name)};
+    // The map picks its bucket from the low bits of the hash, so pick the shard from the high ones.
+    Shard &shard = shards[(key.hash >> (sizeof(size_t) * 4)) % shardCount];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(key);
+        if (it != shard.ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(key);
+    if (it != shard.ids.end()) {
+        // Another thread interned it meanwhile.
+        return it->second;
+    }
+    key.name = shard.names.copy(name);
+    uint32_t id;
+    {
+        std::unique_lock<std::shared_mutex> namesLock(namesMutex);
+        id = (uint32_t) names.size();
+        names.push_back(key.name);
+    }
+    shard.ids.emplace(key, id);
+    return id;
+}
+
+std::string_view IdentifierInterner::name(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(namesMutex);
+    return names[id];
+}
+
+size_t IdentifierInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(namesMutex);
+    return names.size();
+}
@@ -0,0 +1,116 @@
+#include "../include/incremental_lexer.h"
+#include "../include/lexer.h"
+#include "../include/unicode.h"
+#include <algorithm>
+
+IncrementalLexer::IncrementalLexer(std::string source) : source(std::move(source)) {
+    buffer = tokenizeCompact(this->source);
+}
+
+/**
+ * Finds the token to restart lexing from for an edit at `offset`.
+ *
+ * That is the token before the first one that reaches `offset`: the first token may end because
+ * of the character at `offset`, and the one before it may have looked one character ahead, so
+ * everything before the restart token is unaffected by the edit. A word may also read further
+ * ahead, over a '\' and the tokens after it that an edit turns into a Unicode escape, over
+ * the bytes of an incomplete UTF-8 character, or, for the word `non`, over the "-sealed" of
+ * `non-sealed` and the identifier character after it, so the restart token moves back past those.
+ */
+size_t IncrementalLexer::restartToken(size_t offset) const {
+    // Binary search for the first token that ends at or after `offset`.
+    size_t low = 0;
+    size_t high = buffer.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (buffer.offsets[middle] + buffer.lengths[middle] < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    size_t restart = low > 0 ? low - 1 : 0;
+
+    auto isUnicodeUnknown = [&](size_t index) {
+        return buffer.type(index) == TokenType::UNKNOWN && isUnicodeStart(source[buffer.offsets[index]]);
+    };
+    while (restart > 0 && restart < buffer.size() && (isUnicodeUnknown(restart) || isUnicodeUnknown(restart - 1))) {
+        restart--;
+    }
+
+    // If `non` did not join "-sealed", the '-' and the word after it are the next two tokens.
+    for (size_t back = 1; back <= 2 && back <= restart && restart < buffer.size(); back++) {
+        size_t word = restart - back;
+        if (buffer.type(word) == TokenType::IDENTIFIER && buffer.lexeme(word) == "non" &&
+            buffer.lexeme(word + 1).starts_with('-')) {
+            restart = word;
+            break;
+        }
+    }
+    return restart;
+}
+
+TokenEdit IncrementalLexer::edit(size_t offset, size_t removed, std::string_view inserted) {
+    offset = std::min(offset, source.size());
+    removed = std::min(removed, source.size() - offset);
+    size_t editEnd = offset + removed;                  // End of the edit in old offsets.
+    auto delta = (uint32_t) (inserted.size() - removed); // Shift of old offsets after the edit.
+
+    size_t restart = restartToken(offset);
+    source.replace(offset, removed, inserted);
+    buffer.source = source;
+    buffer.lines.edit((uint32_t) offset, (uint32_t) removed, inserted);
+
+    // At the start of a token the lexer is always in `STATE_NONE`.
+    LexerSnapshot snapshot = {
+            .state = STATE_NONE,
+            .position = {0, 1, 1},
+            .prev_c = '\0',
+            .hasEmitted = false,
+            .lastType = TokenType::UNKNOWN,
+    };
+    if (restart > 0) {
+        int start = (int) buffer.offsets[restart];
+        snapshot.position = buffer.lines.position(start);
+        snapshot.wordStart = start;
+        snapshot.prev_c = source[start - 1];
+        snapshot.hasEmitted = true;
+        snapshot.lastType = buffer.type(restart - 1);
+    }
+    Lexer lexer(source, snapshot, {.trackPositions = false});
+
+    // Lex until a token starts where an old token after the edit starts, in the same state.
+    TokenBuffer lexed;
+    size_t old = restart;
+    size_t resync = buffer.size();
+    bool hasEmitted = snapshot.hasEmitted;
+    TokenType lastType = snapshot.lastType;
+    while (auto token = lexer.next()) {
+        auto start = (uint32_t) token->position.index;
+        while (old < buffer.size() && (buffer.offsets[old] < editEnd || buffer.offsets[old] + delta < start)) {
+            old++;
+        }
+        if (old < buffer.size() && buffer.offsets[old] + delta == start &&
+            hasEmitted == (old > 0) && (old == 0 || lastType == buffer.type(old - 1))) {
+            resync = old;
+            break;
+        }
+        lexed.push_back(*token);
+        hasEmitted = true;
+        lastType = token->type;
+    }
+
+    // Replace the re-lexed tokens and shift the ones after them.
+    auto splice = [&](auto &column, auto &replacement) {
+        column.erase(column.begin() + (long) restart, column.begin() + (long) resync);
+        column.insert(column.begin() + (long) restart, replacement.begin(), replacement.end());
+    };
+    size_t shiftFrom = restart + lexed.size();
+    splice(buffer.types, lexed.types);
+    splice(buffer.offsets, lexed.offsets);
+    splice(buffer.lengths, lexed.lengths);
+    for (size_t i = shiftFrom; i < buffer.offsets.size(); i++) {
+        buffer.offsets[i] += delta;
+    }
+    return {restart, resync - restart, lexed.size()};
+}
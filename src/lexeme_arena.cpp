@@ -0,0 +1,48 @@
+#include "../include/lexeme_arena.h"
+#include <algorithm>
+#include <utility>
+
+LexemeArena::LexemeArena(LexemeArena &&other) noexcept
+        : blocks(std::move(other.blocks)),
+          cursor(std::exchange(other.cursor, nullptr)),
+          remaining(std::exchange(other.remaining, 0)),
+          allocated(std::exchange(other.allocated, 0)),
+          blockSize(other.blockSize) {}
+
+LexemeArena &LexemeArena::operator=(LexemeArena &&other) noexcept {
+    if (this != &other) {
+        blocks = std::move(other.blocks);
+        cursor = std::exchange(other.cursor, nullptr);
+        remaining = std::exchange(other.remaining, 0);
+        allocated = std::exchange(other.allocated, 0);
+        blockSize = other.blockSize;
+    }
+    return *this;
+}
+
+void LexemeArena::reserve(size_t bytes) {
+    if (bytes > remaining) {
+        addBlock(bytes);
+    }
+}
+
+void LexemeArena::clear() {
+    blocks.clear();
+    cursor = nullptr;
+    remaining = 0;
+    allocated = 0;
+}
+
+void LexemeArena::grow(size_t minimum) {
+    addBlock(std::max(minimum, blockSize));
+}
+
+/**
+ * Starts a new block of the given size. The free space left in the previous block is abandoned.
+ */
+void LexemeArena::addBlock(size_t size) {
+    blocks.push_back(std::make_unique_for_overwrite<char[]>(size));
+    cursor = blocks.back().get();
+    remaining = size;
+    allocated += size;
+}
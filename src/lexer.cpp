@@ -1,31 +1,47 @@
 #include <iostream>
+#include <algorithm>
+#include <mutex>
+#include <ranges>
 #include "../include/lexer.h"
 #include "../include/token_matcher.h"
 #include "../include/number_helper.h"
+#include "../include/scan.h"
+#include "../include/identifier_interner.h"
+#include "../include/dfa_lexer.h"
+#include "../include/unicode.h"
+
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
 
 /**
- * Enum representing the possible states of the tokenizer during lexical analysis.
+ * Reads a cheap, monotonic cycle counter for `LexerStats::sampledCycles`.
  */
-enum TokenizerState {
-    STATE_NONE,            // No specific state; beginning or resetting tokenization.
-    STATE_WORD,            // Reading an identifier or keyword.
-    STATE_LINE_COMMENT,    // Inside a single-line comment.
-    STATE_BLOCK_COMMENT,   // Inside a multi-line block comment.
-    STATE_LITERAL_STRING,  // Inside a string literal.
-    STATE_LITERAL_CHAR,    // Inside a character literal.
-    STATE_OPERATORS,       // Parsing operators.
-    STATE_NUMBERS,         // Parsing numbers.
-    STATE_HEX,             // Parsing a hexadecimal number.
-    STATE_BINARY,          // Parsing a binary number.
-};
+inline uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+std::mutex statsMutex;  // Guards `collectedStats`.
+LexerStats collectedStats;  // Counters of all destroyed lexers.
+#endif
 
 /**
- * Struct representing additional information when parsing numbers.
+ * Extends a lexeme by the next characters of the source buffer it points into.
+ * Lexemes are always contiguous slices of the source, so this never copies.
+ * @param word The lexeme being accumulated.
+ * @param count Number of characters to append.
  */
-struct NumberInfo {
-    bool hasUsedDot;  // True if the number contains a decimal point.
-    bool hasUsedE;    // True if the number contains an exponent ('e' or 'E').
-};
+inline void growWord(std::string_view &word, size_t count = 1) {
+    word = std::string_view(word.data(), word.size() + count);
+}
 
 /**
  * Handles the initial classification of a character and transitions to the appropriate tokenizer state.
@@ -40,6 +56,7 @@ struct NumberInfo {
  *   - Detects multi-line comments starting with `/ *` and transitions to `STATE_BLOCK_COMMENT`.
  * - Literal Detection:
  *   - Detects string literals starting with `"` and transitions to `STATE_LITERAL_STRING`.
+ *   - Detects text blocks starting with `"""` and transitions to `STATE_TEXT_BLOCK`.
  *   - Detects character literals starting with `'` and transitions to `STATE_LITERAL_CHAR`.
  * - Number Detection:
  *   - Detects hexadecimal numbers starting with `0x` or `0X` and transitions to `STATE_HEX`.
@@ -50,26 +67,19 @@ struct NumberInfo {
  *   - Recognizes whitespace and emits a `WHITESPACE` token.
  *   - Identifies identifiers (e.g., variable names, keywords) and transitions to `STATE_WORD`.
  *
- * @param tokens Reference to the vector where generated tokens are stored.
- * @param position Current position in the source code, used to track the location of the token.
- * @param word Accumulator for the current token being processed.
- * @param state Current tokenizer state, which will be updated based on the character type.
  * @param c Current character being analyzed.
  * @param next_c Next character in the input sequence, used for lookahead operations.
  */
-void consume(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        char next_c
-) {
-    word = c;
+void Lexer::consume(char c, char next_c) {
+    word = source.substr(position.index, 1);
     if (c == '/' && next_c == '/') {
         state = TokenizerState::STATE_LINE_COMMENT;
     } else if (c == '/' && next_c == '*') {
         state = TokenizerState::STATE_BLOCK_COMMENT;
+    } else if (c == '"' && next_c == '"' && source.substr(position.index, 3) == "\"\"\"") {
+        state = TokenizerState::STATE_TEXT_BLOCK;
+        word = source.substr(position.index, 3);
+        position.index += 2;
     } else if (c == '"') {
         state = TokenizerState::STATE_LITERAL_STRING;
     } else if (c == '\'') {
@@ -78,32 +88,44 @@ void consume(
         state = TokenizerState::STATE_HEX;
     } else if (c == '0' && (next_c == 'b' || next_c == 'B')) {
         state = TokenizerState::STATE_BINARY;
-    } else if (c == '@' && isIdentifierLetter(std::string{next_c})) { // NOLINT(bugprone-branch-clone)
+    } else if (c == '@' && (isIdentifierLetter(next_c) || // NOLINT(bugprone-branch-clone)
+                            (isUnicodeStart(next_c) && identifierCharLength(source, position.index + 1, false) > 0))) {
         state = TokenizerState::STATE_WORD;
     } else if (isNumberStarter(c, next_c)) {
         state = TokenizerState::STATE_NUMBERS;
-    } else if (isOperatorStart(word)) {
+    } else if (isOperatorStart(c)) {
         state = TokenizerState::STATE_OPERATORS;
     } else if (isSymbol(word)) {
         bool isDoubleColon = c == ':' && next_c == ':';
         if (isDoubleColon) {
-            word += next_c;
+            growWord(word);
             position.index++;
         }
-        tokens.emplace_back(TokenType::SYMBOL, word, position, 1);
-        position.column += (int) word.size();
+        emit(TokenType::SYMBOL, word, word.size() - 1);
         word = "";
-    } else if (isWhitespace(word)) {
-        if (!tokens.empty() && tokens.back().type != WHITESPACE) {
-            tokens.emplace_back(TokenType::WHITESPACE, word, position, 0);
+    } else if (isWhitespace(c)) {
+        if (hasEmitted && lastType != WHITESPACE) {
+            emit(TokenType::WHITESPACE, word, 0);
         }
-        position.column += (int) word.size();
         word = "";
-    } else if (isIdentifier(word)) {
+    } else if (isIdentifierStart(c)) {
         state = TokenizerState::STATE_WORD;
+    } else if (isUnicodeStart(c)) {
+        // A non-ASCII character or a Unicode escape either starts a word, or is one `UNKNOWN` token.
+        size_t length = identifierCharLength(source, position.index, true);
+        if (length > 0) {
+            state = TokenizerState::STATE_WORD;
+        } else {
+            length = utf8SequenceLength(source, position.index);
+        }
+        word = source.substr(position.index, length);
+        position.index += (int) length - 1;
+        if (state != TokenizerState::STATE_WORD) {
+            emit(TokenType::UNKNOWN, word, (int) length - 1);
+            word = "";
+        }
     } else {
-        tokens.emplace_back(TokenType::UNKNOWN, word, position, 0);
-        position.column += (int) word.size();
+        emit(TokenType::UNKNOWN, word, 0);
         word = "";
     }
 }
@@ -116,31 +138,35 @@ void consume(
  * encountering a character that is not part of an identifier.
  *
  * Key Responsibilities:
- * - Accumulate valid identifier characters (`[a-zA-Z0-9_$]`).
- * - Finalize and emit tokens for completed words.
+ * - Accumulate valid identifier characters (`[a-zA-Z0-9_$]`, and non-ASCII ones and Unicode escapes, see `unicode.h`).
+ * - Finalize and emit tokens for completed words, joining `non` and a following "-sealed" into `non-sealed`.
  * - Transition back to `STATE_NONE` after emitting the token.
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word The current word being processed.
- * @param state Current tokenizer state.
  * @param c Current character.
  * @return true if the character was consumed as part of the word; false otherwise.
  */
-bool consumeWord(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c
-) {
-    std::string c_str{c};
-    if (isIdentifierLetter(c_str)) {
-        word += c;
+bool Lexer::consumeWord(char c) {
+    if (isIdentifierLetter(c)) {
+        growWord(word);
+        return true;
+    }
+    size_t length = isUnicodeStart(c) ? identifierCharLength(source, position.index, false) : 0;
+    if (length > 0) {
+        growWord(word, length);
+        position.index += (int) length - 1;
+        return true;
+    }
+
+    size_t suffix = c == '-' && word == "non" ? nonSealedSuffixLength(source, position.index) : 0;
+    if (suffix > 0) {
+        growWord(word, suffix);
+        position.index += (int) suffix - 1;
+        emit(TokenType::CONTEXTUAL_KEYWORD, word, word.size() - 1);
+        word = "";
+        state = TokenizerState::STATE_NONE;
         return true;
     } else {
-        tokens.emplace_back(getTokenType(word), word, position, word.size());
-        position.column += (int) word.size();
+        emit(getTokenType(word), word, word.size());
         word = "";
         state = TokenizerState::STATE_NONE;
         return false;
@@ -158,26 +184,15 @@ bool consumeWord(
  * - Finalize the comment token at the end of the line.
  * - Transition back to `STATE_NONE` after emitting the token.
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the comment.
- * @param state Current tokenizer state.
  * @param c Current character.
  */
-void consumeLineComment(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c
-) {
+void Lexer::consumeLineComment(char c) {
     if (c == '\n') {
-        tokens.emplace_back(TokenType::LINE_COMMENT, word, position, word.size());
-        position.column += (int) word.size();
+        emit(TokenType::LINE_COMMENT, word, word.size());
         word = "";
         state = TokenizerState::STATE_NONE;
     } else {
-        word += c;
+        growWord(word);
     }
 }
 
@@ -193,36 +208,19 @@ void consumeLineComment(
  * - Detect the closing sequence (`* /`) to finalize the comment token.
  * - Transition back to `STATE_NONE` after emitting the token.
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param startPosition Position where the block comment started.
- * @param word Accumulated characters of the comment.
- * @param state Current tokenizer state.
  * @param c Current character.
- * @param prev_c Previous character, used to detect the closing `* /`.
- * @param isEOF true if processing final character.
  */
-void consumeBlockComment(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        struct Position &startPosition,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        char prev_c,
-        bool isEOF
-) {
+void Lexer::consumeBlockComment(char c) {
     bool isClosing = prev_c == '*' && c == '/';
     if (!isEOF || isClosing) {
-        word += c;
-        position.column++;
+        growWord(word);
     }
     if (isClosing) {
-        tokens.emplace_back(TokenType::BLOCK_COMMENT, word, startPosition, 0);
+        emitAt(TokenType::BLOCK_COMMENT, word, blockCommentPositionSaver);
         word = "";
         state = TokenizerState::STATE_NONE;
     } else if (isEOF) {
-        tokens.emplace_back(TokenType::UNKNOWN, word, startPosition, 0);
+        emitAt(TokenType::UNKNOWN, word, blockCommentPositionSaver);
         word = "";
         state = TokenizerState::STATE_NONE;
     }
@@ -240,34 +238,60 @@ void consumeBlockComment(
  * - Finalize the string literal token when the closing quote is encountered.
  * - Emit an `UNKNOWN` token if the string is invalid (e.g., unclosed string).
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the string literal.
- * @param state Current tokenizer state.
  * @param c Current character.
- * @param prev_c Previous character, used to detect escaped quotes.
  */
-void consumeLiteralString(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        char prev_c
-) {
+void Lexer::consumeLiteralString(char c) {
     if (c == '\n') {
-        tokens.emplace_back(TokenType::UNKNOWN, word, position, word.size());
+        emit(TokenType::UNKNOWN, word, word.size());
         word = "";
         state = TokenizerState::STATE_NONE;
         return;
     }
 
-    word += c;
+    growWord(word);
     if (prev_c != '\\' && c == '"') {
-        tokens.emplace_back(TokenType::STRING, word, position, word.size() - 1);
-        position.column += (int) word.size();
+        emit(TokenType::STRING, word, word.size() - 1);
+        word = "";
+        state = TokenizerState::STATE_NONE;
+    }
+}
+
+/**
+ * Processes text blocks (e.g., `"""\nhello"""`).
+ *
+ * This function is used when the lexer is in the `STATE_TEXT_BLOCK` state. It accumulates
+ * characters, including newlines, until the closing `"""`, whose first quote must not be escaped:
+ * a '\' escapes the character after it, so the number of backslashes before the quote decides.
+ * The start position of the text block is preserved, like that of a block comment.
+ *
+ * Key Responsibilities:
+ * - Accumulate all characters of the text block, including escaped quotes and newlines.
+ * - Finalize the text block token when the closing `"""` is encountered.
+ * - Emit an `UNKNOWN` token if the text block is not closed before the end of the source.
+ *
+ * @param c Current character.
+ */
+void Lexer::consumeTextBlock(char c) {
+    if (isEOF) {
+        emitAt(TokenType::UNKNOWN, word, blockCommentPositionSaver);
         word = "";
         state = TokenizerState::STATE_NONE;
+        return;
+    }
+
+    growWord(word);
+    // The opening `"""` is part of `word`, and none of its quotes may be part of the closing one.
+    size_t closing = word.size() - 3;
+    if (c == '"' && closing >= 3 && word.substr(closing) == "\"\"\"") {
+        size_t backslashes = 0;
+        while (word[closing - 1 - backslashes] == '\\') {
+            backslashes++;
+        }
+        if (backslashes % 2 == 0) {
+            emitAt(TokenType::TEXT_BLOCK, word, blockCommentPositionSaver);
+            word = "";
+            state = TokenizerState::STATE_NONE;
+        }
     }
 }
 
@@ -284,32 +308,19 @@ void consumeLiteralString(
  * - Finalize the character literal token when the closing quote is encountered.
  * - Emit an `UNKNOWN` token if the character literal is invalid (e.g., unclosed or multiline).
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the character literal.
- * @param state Current tokenizer state.
  * @param c Current character.
- * @param prev_c Previous character, used to detect escaped characters.
  */
-void consumeLiteralChar(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        char prev_c
-) {
+void Lexer::consumeLiteralChar(char c) {
     if (c == '\n') {
-        tokens.emplace_back(TokenType::UNKNOWN, word, position, word.size());
+        emit(TokenType::UNKNOWN, word, word.size());
         word = "";
         state = TokenizerState::STATE_NONE;
         return;
     }
 
-    word += c;
+    growWord(word);
     if (prev_c != '\\' && c == '\'') {
-        tokens.emplace_back(TokenType::CHAR, word, position, word.size() - 1);
-        position.column += (int) word.size();
+        emit(TokenType::CHAR, word, word.size() - 1);
         word = "";
         state = TokenizerState::STATE_NONE;
     }
@@ -360,22 +371,11 @@ bool isUnmatchedOperator(char prev_c, char c) {
  *   be processed here. However, at the end, when `getTokenType` is called, it
  *   will classify `->` as a `SYMBOL` type rather than an `OPERATOR`.
  *
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the operator.
- * @param state Current tokenizer state.
  * @param c Current character.
-  * @param next_c Next character in the source, Used to identify comment openings.
+ * @param next_c Next character in the source, Used to identify comment openings.
  * @return true if the character was consumed as part of the operator; false otherwise.
  */
-bool consumeOperator(
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        char next_c
-) {
+bool Lexer::consumeOperator(char c, char next_c) {
     // Checks if the current character (`c`) starts a comment,
     // either single-line (`//`) or block (`/*`).
     bool isFollowingByComment = c == '/' && (next_c == '/' || next_c == '*');
@@ -395,12 +395,11 @@ bool consumeOperator(
                        !isIncreaseDecrease &&
                        !isUnmatched;
 
-    if (canContinue && isOperatorStart(std::string{c})) {
-        word += c;
+    if (canContinue && isOperatorStart(c)) {
+        growWord(word);
         return true;
     } else {
-        tokens.emplace_back(getTokenType(word), word, position, word.size());
-        position.column += (int) word.size();
+        emit(getTokenType(word), word, word.size());
         word = "";
         state = TokenizerState::STATE_NONE;
         return false;
@@ -421,55 +420,37 @@ bool consumeOperator(
  * - Finalize the number token when encountering a non-numeric character.
  * - Emit an `UNKNOWN` token for invalid numbers.
  *
- * @param source The full source code being tokenized.
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the number.
- * @param state Current tokenizer state.
- * @param numberInfo Additional information about the number (e.g., use of dot or exponent).
- * @param prev_c Previous character in the source.
  * @param c Current character.
  * @param next_c Next character in the source.
  * @return true if the character was consumed as part of the number; false otherwise.
  */
-bool consumeNumber(
-        const std::string &source,
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        struct NumberInfo &numberInfo,
-        char prev_c,
-        char c,
-        char next_c
-) {
-    std::string underscore = consumeUnderscoreInNumber(source, position.index, false, false);
+bool Lexer::consumeNumber(char c, char next_c) {
+    std::string_view underscore = consumeUnderscoreInNumber(source, position.index, false, false);
     if (!underscore.empty()) {
-        word += underscore;
+        growWord(word, underscore.size());
         position.index += (int) underscore.size() - 1;
         return true;
     }
 
     if (isNumber(c) ||
         (numberInfo.hasUsedE && (prev_c == 'e' || prev_c == 'E') && (c == '-' || c == '+'))) {
-        word += c;
+        growWord(word);
         return true;
     } else if (!numberInfo.hasUsedDot && c == '.') {
-        word += c;
+        growWord(word);
         numberInfo.hasUsedDot = true;
         return true;
     } else if (!numberInfo.hasUsedE && (c == 'e' || c == 'E') &&
                (isNumber(next_c) || next_c == '+' || next_c == '-')) {
-        word += c;
+        growWord(word);
         numberInfo.hasUsedE = true;
         return true;
     } else {
         bool isType = isNumberTypeIdentifier(c, !numberInfo.hasUsedE && !numberInfo.hasUsedDot);
         if (isType) {
-            word += c;
+            growWord(word);
         }
-        tokens.emplace_back(TokenType::NUMBER, word, position, word.size() - isType);
-        position.column += (int) word.size();
+        emit(TokenType::NUMBER, word, word.size() - isType);
         word = "";
         state = TokenizerState::STATE_NONE;
         return isType;
@@ -489,159 +470,619 @@ bool consumeNumber(
  * - Finalize the number token when encountering an invalid character.
  * - Recognize type suffixes like `l` or `L` (for long).
  *
- * @param source The full source code being tokenized.
- * @param tokens Reference to the vector of tokens.
- * @param position Current position in the source code.
- * @param word Accumulated characters of the number.
- * @param state Current tokenizer state.
  * @param c Current character.
  * @param isBinary true if processing a binary number; false for hexadecimal.
  * @return true if the character was consumed as part of the number; false otherwise.
  */
-bool consumeHexAndBinary(
-        const std::string &source,
-        std::vector<Token> &tokens,
-        struct Position &position,
-        std::string &word,
-        TokenizerState &state,
-        char c,
-        bool isBinary
-) {
-    std::string underscore = consumeUnderscoreInNumber(source, position.index, isBinary, !isBinary);
+bool Lexer::consumeHexAndBinary(char c, bool isBinary) {
+    std::string_view underscore = consumeUnderscoreInNumber(source, position.index, isBinary, !isBinary);
     if (!underscore.empty()) {
-        word += underscore;
+        growWord(word, underscore.size());
         position.index += (int) underscore.size() - 1;
         return true;
     }
 
     if (word.size() == 1 || // allow '0x' or '0b' prefixes
         isHexOrBinaryNumber(c, isBinary)) {
-        word += c;
+        growWord(word);
         return true;
     } else {
         bool isType = c == 'l' || c == 'L';
         if (isType) {
-            word += c;
+            growWord(word);
         }
         TokenType type = isBinary ? TokenType::BINARY_NUMBER : TokenType::HEX_NUMBER;
         type = word.size() >= (isType ? 4 : 3) ? type : TokenType::UNKNOWN;
-        tokens.emplace_back(type, word, position, word.size() - isType);
-        position.column += (int) word.size();
+        emit(type, word, word.size() - isType);
         word = "";
         state = TokenizerState::STATE_NONE;
         return isType;
     }
 }
 
+static_assert(std::ranges::input_range<Lexer>, "Lexer must be usable as a C++20 range");
+
+std::string_view getTokenizerStateName(TokenizerState state) {
+    switch (state) {
+        case TokenizerState::STATE_NONE:
+            return "STATE_NONE";
+        case TokenizerState::STATE_WORD:
+            return "STATE_WORD";
+        case TokenizerState::STATE_LINE_COMMENT:
+            return "STATE_LINE_COMMENT";
+        case TokenizerState::STATE_BLOCK_COMMENT:
+            return "STATE_BLOCK_COMMENT";
+        case TokenizerState::STATE_LITERAL_STRING:
+            return "STATE_LITERAL_STRING";
+        case TokenizerState::STATE_TEXT_BLOCK:
+            return "STATE_TEXT_BLOCK";
+        case TokenizerState::STATE_LITERAL_CHAR:
+            return "STATE_LITERAL_CHAR";
+        case TokenizerState::STATE_OPERATORS:
+            return "STATE_OPERATORS";
+        case TokenizerState::STATE_NUMBERS:
+            return "STATE_NUMBERS";
+        case TokenizerState::STATE_HEX:
+            return "STATE_HEX";
+        case TokenizerState::STATE_BINARY:
+            return "STATE_BINARY";
+    }
+    return "STATE_NONE";
+}
+
+LexerStats &LexerStats::operator+=(const LexerStats &other) {
+    for (size_t i = 0; i < tokenizer_state_count; i++) {
+        bytes[i] += other.bytes[i];
+        tokens[i] += other.tokens[i];
+        redispatches[i] += other.redispatches[i];
+        steps[i] += other.steps[i];
+        sampledSteps[i] += other.sampledSteps[i];
+        sampledCycles[i] += other.sampledCycles[i];
+    }
+    return *this;
+}
+
+LexerStats lexerStats() {
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return collectedStats;
+#else
+    return {};
+#endif
+}
+
+void resetLexerStats() {
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    std::lock_guard<std::mutex> lock(statsMutex);
+    collectedStats = {};
+#endif
+}
+
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+Lexer::~Lexer() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    collectedStats += stats;
+}
+#endif
+
+Lexer::Lexer(std::string_view source, const LexOptions &options)
+        : source(source),
+          trackPositions(options.trackPositions),
+          emitTypes(options.emitTypes),
+          interner(options.interner),
+          parseNumbers(options.parseNumbers) {
+    if (!trackPositions) {
+        position.line = 0;
+    }
+}
+
+Lexer::Lexer(std::string_view source, const LexerSnapshot &snapshot, const LexOptions &options)
+        : source(source),
+          state(snapshot.state),
+          position(snapshot.position),
+          lineStart(snapshot.position.index - snapshot.position.column + 1),
+          trackPositions(options.trackPositions),
+          emitTypes(options.emitTypes),
+          interner(options.interner),
+          parseNumbers(options.parseNumbers),
+          blockCommentPositionSaver(snapshot.blockCommentStart),
+          numberInfo(snapshot.numberInfo),
+          word(source.substr(snapshot.wordStart, snapshot.position.index - snapshot.wordStart)),
+          prev_c(snapshot.prev_c),
+          hasEmitted(snapshot.hasEmitted),
+          lastType(snapshot.lastType) {}
+
+LexerSnapshot Lexer::snapshot() const {
+    return {
+            .state = state,
+            .position = {position.index + indexBase, position.line, position.index - lineStart + 1},
+            .blockCommentStart = {blockCommentPositionSaver.index + indexBase,
+                                  blockCommentPositionSaver.line,
+                                  blockCommentPositionSaver.column},
+            .numberInfo = numberInfo,
+            .wordStart = (int) (word.empty() ? position.index : word.data() - source.data()) + indexBase,
+            .prev_c = prev_c,
+            .hasEmitted = hasEmitted,
+            .lastType = lastType,
+    };
+}
+
 /**
- * Tokenizes the given Java source code into a sequence of tokens.
- *
- * This function orchestrates the entire lexical analysis process. It processes
- * the source code character by character, maintaining the current state and invoking
- * appropriate `consume` functions for handling specific token types (e.g., identifiers,
- * comments, literals, and numbers).
+ * Computes the position of a character on the current line.
+ * @param index Index of the character in `source`.
+ */
+struct Position Lexer::positionOf(int index) const {
+    return {index, position.line, trackPositions ? index - lineStart + 1 : 0};
+}
+
+/**
+ * Appends a finalized token that started on the current line.
  *
- * Key Responsibilities:
- * - Iterates through each character in the source code.
- * - Maintains line and column positions to track token locations.
- * - Transitions between states for specific token types.
- * - Emits tokens into the `tokens` vector as they are finalized.
- * - Handles special cases like EOF and ensures any remaining tokens are processed.
- *
- * @param source The Java source code as a string.
- * @return A vector of tokens representing the lexical elements of the source code.
+ * @param type The type of the token.
+ * @param lexeme The text of the token, a view into the source.
+ * @param indexOffset Distance between the current position and the start of the token.
  */
-std::vector<Token> tokenize(const std::string &source) {
-    struct Position blockCommentPositionSaver{};
-    struct NumberInfo numberInfo{};
-    struct Position position = {
-            .index = 0,
-            .line = 1,
-            .column = 1
-    };
+void Lexer::emit(TokenType type, std::string_view lexeme, int indexOffset) {
+    emitAt(type, lexeme, positionOf(position.index - indexOffset));
+}
 
-    std::vector<Token> tokens;
-    std::string word;
+/**
+ * Appends a finalized token to the output and remembers its type.
+ *
+ * Tokens whose type is not in `emitTypes` are dropped. The type of the last emitted token,
+ * output or not, decides whether the next whitespace character is emitted as a `WHITESPACE`
+ * token or merged into the previous one.
+ *
+ * @param type The type of the token.
+ * @param lexeme The text of the token, a view into the source.
+ * @param start The position of the first character of the token.
+ */
+void Lexer::emitAt(TokenType type, std::string_view lexeme, struct Position start) {
+    if ((emitTypes & tokenTypeBit(type)) != 0) {
+        start.index += indexBase;
+        TokenView &token = output->emplace_back(type, lexeme, start, 0);
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+        stats.tokens[state]++;
+#endif
+        if (interner != nullptr && isInternedWord(type, lexeme)) {
+            token.id = interner->intern(lexeme);
+        } else if (parseNumbers && (type == TokenType::NUMBER || type == TokenType::HEX_NUMBER ||
+                                    type == TokenType::BINARY_NUMBER)) {
+            NumberLiteral literal = parseNumberLiteral(type, lexeme);
+            token.numberKind = literal.kind;
+            token.numberOverflow = literal.overflow;
+            token.number = literal.value;
+        }
+    }
+    // Suppressed tokens still decide how the next whitespace is handled.
+    hasEmitted = true;
+    lastType = type;
+}
 
-    TokenizerState currentState = STATE_NONE;
-    char prev_c = '\0';
-    bool isEOF = false;
+/**
+ * Runs the consumer of the current state for one character.
+ *
+ * @param c Current character.
+ * @param next_c Next character in the source, used for lookahead operations.
+ * @return true if the character was consumed; false if the state changed and the
+ *         character must be processed again by the consumer of the new state.
+ */
+bool Lexer::dispatch(char c, char next_c) {
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    TokenizerState dispatched = state;
+#endif
+    bool hasConsumed = true;
+    switch (state) {
+        case TokenizerState::STATE_NONE:
+            consume(c, next_c);
+            if (state == TokenizerState::STATE_BLOCK_COMMENT) {
+                // Save the starting position of the block comment.
+                // Block comments can have multiple lines and include '\n',
+                // which moves the current line. By saving the start position,
+                // we ensure accurate token location data for block comments.
+                blockCommentPositionSaver = positionOf(position.index);
+            } else if (state == TokenizerState::STATE_TEXT_BLOCK) {
+                // Text blocks span lines too; `consume` has moved past the opening `"""`.
+                blockCommentPositionSaver = positionOf(position.index - 2);
+            } else if (state == TokenizerState::STATE_NUMBERS) {
+                numberInfo.hasUsedDot = c == '.';
+                numberInfo.hasUsedE = false;
+            }
+            break;
+        case TokenizerState::STATE_WORD:
+            hasConsumed = consumeWord(c);
+            break;
+        case TokenizerState::STATE_LINE_COMMENT:
+            consumeLineComment(c);
+            break;
+        case TokenizerState::STATE_BLOCK_COMMENT:
+            consumeBlockComment(c);
+            break;
+        case TokenizerState::STATE_LITERAL_STRING:
+            consumeLiteralString(c);
+            break;
+        case TokenizerState::STATE_TEXT_BLOCK:
+            consumeTextBlock(c);
+            break;
+        case TokenizerState::STATE_LITERAL_CHAR:
+            consumeLiteralChar(c);
+            break;
+        case TokenizerState::STATE_OPERATORS:
+            hasConsumed = consumeOperator(c, next_c);
+            break;
+        case TokenizerState::STATE_NUMBERS:
+            hasConsumed = consumeNumber(c, next_c);
+            break;
+        case TokenizerState::STATE_HEX:
+            hasConsumed = consumeHexAndBinary(c, false);
+            break;
+        case TokenizerState::STATE_BINARY:
+            hasConsumed = consumeHexAndBinary(c, true);
+            break;
+    }
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    stats.redispatches[dispatched] += !hasConsumed;
+#endif
+    return hasConsumed;
+}
 
-    while (source.length() > position.index) {
+/**
+ * Processes the character at the current position.
+ *
+ * This function drives the state machine by one character. It invokes the consumer of
+ * the current state, re-processing the character whenever a state ends without consuming
+ * it, and then advances the line used to track token locations, unless positions are not tracked.
+ * After the last character of the source it finalizes any unprocessed token.
+ */
+void Lexer::step() {
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    TokenizerState stepState = state;
+    int stepStart = position.index;
+    stats.steps[stepState]++;
+    // xorshift32, see Marsaglia, "Xorshift RNGs".
+    sampleSeed ^= sampleSeed << 13;
+    sampleSeed ^= sampleSeed >> 17;
+    sampleSeed ^= sampleSeed << 5;
+    bool isSampled = (sampleSeed & (lexer_stats_sample_interval - 1)) == 0;
+    uint64_t stepCycles = isSampled ? readCycleCounter() : 0;
+#endif
+    if (!skipSpan()) {
         char c = source[position.index];
         char next_c = source.length() > position.index + 1 ? source[position.index + 1] : '\0';
 
-        // Label for state transitions that require re-processing
-        CONSUMER:
-        bool hasConsumed = true;
-        switch (currentState) {
-            case TokenizerState::STATE_NONE:
-                consume(tokens, position, word, currentState, c, next_c);
-                if (currentState == TokenizerState::STATE_BLOCK_COMMENT) {
-                    // Save the starting position of the block comment.
-                    // Block comments can have multiple lines and include '\n',
-                    // which resets the column counter. By saving the start position,
-                    // we ensure accurate token location data for block comments.
-                    blockCommentPositionSaver = position;
-                } else if (currentState == TokenizerState::STATE_NUMBERS) {
-                    numberInfo.hasUsedDot = c == '.';
-                    numberInfo.hasUsedE = false;
-                }
-                break;
-            case TokenizerState::STATE_WORD:
-                hasConsumed = consumeWord(tokens, position, word, currentState, c);
-                break;
-            case TokenizerState::STATE_LINE_COMMENT:
-                consumeLineComment(tokens, position, word, currentState, c);
-                break;
-            case TokenizerState::STATE_BLOCK_COMMENT:
-                consumeBlockComment(tokens, position, blockCommentPositionSaver, word,
-                                    currentState, c, prev_c, isEOF);
-                break;
-            case TokenizerState::STATE_LITERAL_STRING:
-                consumeLiteralString(tokens, position, word, currentState, c, prev_c);
-                break;
-            case TokenizerState::STATE_LITERAL_CHAR:
-                consumeLiteralChar(tokens, position, word, currentState, c, prev_c);
-                break;
-            case TokenizerState::STATE_OPERATORS:
-                hasConsumed = consumeOperator(tokens, position, word, currentState, c, next_c);
-                break;
-            case TokenizerState::STATE_NUMBERS:
-                hasConsumed = consumeNumber(source, tokens, position, word,
-                                            currentState, numberInfo, prev_c, c, next_c);
-                break;
-            case TokenizerState::STATE_HEX:
-                hasConsumed = consumeHexAndBinary(source, tokens, position, word, currentState, c, false);
-                break;
-            case TokenizerState::STATE_BINARY:
-                hasConsumed = consumeHexAndBinary(source, tokens, position, word, currentState, c, true);
-                break;
-        }
-        if (!isEOF && !hasConsumed) {
+        while (!dispatch(c, next_c) && !isEOF) {
             // Re-process the current character if the state changed
             // and previous consumer didn't consume it!
-            goto CONSUMER;
         }
 
         position.index++;
-        if (c == '\n') {
+        if (c == '\n' && trackPositions) {
             position.line++;
-            position.column = 1;
+            lineStart = position.index;
         }
         prev_c = c;
+    }
+#ifdef SIMPLEJAVALEXER_LEXER_STATS
+    stats.bytes[stepState] += position.index - stepStart;
+    if (isSampled) {
+        stats.sampledSteps[stepState]++;
+        stats.sampledCycles[stepState] += readCycleCounter() - stepCycles;
+    }
+#endif
 
-        // Handle end of source: finalize any unprocessed token
-        if (position.index >= source.length() &&
-            currentState != TokenizerState::STATE_NONE &&
-            !word.empty() &&
-            prev_c != '\n') {
-            isEOF = true;
-            c = '\n';
-            // Trigger final processing for the remaining token
-            goto CONSUMER;
+    if (!hasMoreInput && position.index >= source.length()) {
+        finishSource();
+    }
+}
+
+/**
+ * Processes a whole span of characters that need no per-character work, if one starts at
+ * the current position: the body of a comment or literal up to its next possible terminator,
+ * or a run of blanks that is merged into the previous `WHITESPACE` token.
+ *
+ * The span is found with a vectorized scanner (see `scan.h`) and added to the pending lexeme
+ * in one step. Spans never include a newline, so lines are still counted by `step`.
+ *
+ * @return true if a span was processed; false if the current character must be dispatched.
+ */
+bool Lexer::skipSpan() {
+    size_t from = position.index;
+    size_t end;
+    switch (state) {
+        case TokenizerState::STATE_NONE:
+            if (hasEmitted && lastType != WHITESPACE) {
+                // The first whitespace character is emitted by `consume`.
+                return false;
+            }
+            end = skipBlanks(source, from);
+            break;
+        case TokenizerState::STATE_LINE_COMMENT:
+            end = scanUntil(source, from, '\n', '\n');
+            break;
+        case TokenizerState::STATE_BLOCK_COMMENT:
+            end = scanBlockComment(source, from, prev_c);
+            break;
+        case TokenizerState::STATE_LITERAL_STRING:
+            // An escaped quote is left to `consumeLiteralString`, which checks `prev_c`.
+            end = scanUntil(source, from, '"', '\n');
+            break;
+        case TokenizerState::STATE_TEXT_BLOCK:
+            // Quotes, escapes and newlines are left to `consumeTextBlock`.
+            end = scanTextBlock(source, from);
+            break;
+        case TokenizerState::STATE_LITERAL_CHAR:
+            end = scanUntil(source, from, '\'', '\n');
+            break;
+        default:
+            return false;
+    }
+    if (end == from) {
+        return false;
+    }
+
+    if (state != TokenizerState::STATE_NONE) {
+        growWord(word, end - from);
+    }
+    position.index = (int) end;
+    prev_c = source[end - 1];
+    return true;
+}
+
+/**
+ * Handles end of source: finalizes any unprocessed token.
+ */
+void Lexer::finishSource() {
+    if (state != TokenizerState::STATE_NONE &&
+        !word.empty() &&
+        prev_c != '\n') {
+        isEOF = true;
+        // Trigger final processing for the remaining token
+        dispatch('\n', '\0');
+    }
+}
+
+/**
+ * Checks if the character at the current position can be processed.
+ *
+ * When more input may follow (see `PushLexer`), a character is only processed once all
+ * the lookahead it may need is available: the next character, for an underscore inside
+ * a number, the first character after the run of underscores, for a '"' outside comments and
+ * literals, the two characters that may complete a `"""`, for a '-' after the word `non`, the
+ * "-sealed" and the character after it, and for a non-ASCII character or a Unicode escape
+ * outside comments and literals, all of its bytes.
+ *
+ * @return true if `step` can run; false if the source is exhausted or more input is needed.
+ */
+bool Lexer::canStep() const {
+    if (position.index >= source.length()) {
+        return false;
+    }
+    if (!hasMoreInput) {
+        return true;
+    }
+
+    size_t lookahead = position.index + 1;
+    bool isNumberState = state == TokenizerState::STATE_NUMBERS ||
+                         state == TokenizerState::STATE_HEX ||
+                         state == TokenizerState::STATE_BINARY;
+    if (isNumberState && source[position.index] == '_') {
+        while (lookahead < source.length() && source[lookahead] == '_') {
+            lookahead++;
+        }
+    }
+
+    bool isCodeState = state != TokenizerState::STATE_LINE_COMMENT &&
+                       state != TokenizerState::STATE_BLOCK_COMMENT &&
+                       state != TokenizerState::STATE_LITERAL_STRING &&
+                       state != TokenizerState::STATE_TEXT_BLOCK &&
+                       state != TokenizerState::STATE_LITERAL_CHAR;
+    if (isCodeState && source[position.index] == '"') {
+        lookahead = position.index + 2;
+    } else if (state == TokenizerState::STATE_WORD && source[position.index] == '-' && word == "non") {
+        // "-sealed" and the character after it, which may be a non-ASCII identifier character.
+        lookahead = position.index + 7;
+        if (lookahead < source.length() && isUnicodeStart(source[lookahead])) {
+            lookahead = unicodeLookahead(source, lookahead) - 1;
+        }
+    }
+    if (isCodeState) {
+        // An '@' is followed by the first character of an annotation.
+        size_t index = source[position.index] == '@' ? position.index + 1 : position.index;
+        if (index < source.length() && isUnicodeStart(source[index])) {
+            lookahead = std::max(lookahead, unicodeLookahead(source, index) - 1);
+        }
+    }
+    return lookahead < source.length();
+}
+
+/**
+ * Returns the offset in `source` of the earliest character the lexer still needs.
+ *
+ * That is the start of the pending lexeme, or one character before the current position,
+ * since underscores inside numbers look one character behind.
+ */
+long Lexer::retainedOffset() const {
+    long offset = std::max(position.index - 1, 0);
+    if (!word.empty()) {
+        offset = std::min(offset, (long) (word.data() - source.data()));
+    }
+    return offset;
+}
+
+/**
+ * Moves the lexer onto a new buffer holding the same input.
+ *
+ * The new buffer must contain the old one without its first `droppedPrefix` characters,
+ * optionally followed by more input. Positions of emitted tokens remain absolute.
+ *
+ * @param newSource The buffer to continue lexing from.
+ * @param droppedPrefix Number of characters removed from the front of the old buffer.
+ * @param wordOffset Offset of the pending lexeme in the old buffer, if there is one.
+ */
+void Lexer::rebind(std::string_view newSource, int droppedPrefix, long wordOffset) {
+    if (!word.empty()) {
+        word = newSource.substr(wordOffset - droppedPrefix, word.size());
+    }
+    source = newSource;
+    position.index -= droppedPrefix;
+    lineStart -= droppedPrefix;
+    blockCommentPositionSaver.index -= droppedPrefix;
+    indexBase += droppedPrefix;
+}
+
+std::optional<TokenView> Lexer::next() {
+    while (pendingIndex == pending.size()) {
+        if (!canStep()) {
+            return std::nullopt;
+        }
+        pending.clear();
+        pendingIndex = 0;
+        step();
+    }
+    return pending[pendingIndex++];
+}
+
+void Lexer::drain(std::vector<TokenView> &tokens) {
+    tokens.insert(tokens.end(), pending.begin() + (long) pendingIndex, pending.end());
+    pending.clear();
+    pendingIndex = 0;
+
+    output = &tokens;
+    while (canStep()) {
+        step();
+    }
+    output = &pending;
+}
+
+void Lexer::drainUntil(int index, std::vector<TokenView> &tokens) {
+    tokens.insert(tokens.end(), pending.begin() + (long) pendingIndex, pending.end());
+    pending.clear();
+    pendingIndex = 0;
+
+    output = &tokens;
+    while (position.index < index && canStep()) {
+        step();
+    }
+    output = &pending;
+}
+
+size_t estimateTokenCount(size_t bytes, uint32_t emitTypes) {
+    // Java source averages about 5 bytes per token, or about 7.5 without whitespace tokens.
+    // Rounding down the ratio means typical files never have to grow their output.
+    bool hasWhitespace = (emitTypes & tokenTypeBit(TokenType::WHITESPACE)) != 0;
+    return bytes / (hasWhitespace ? 4 : 6) + 16;
+}
+
+void tokenize_view(std::string_view source, std::vector<TokenView> &tokens, const LexOptions &options) {
+    if (options.engine == LexerEngine::DFA) {
+        tokenizeDfa(source, tokens, options);
+        return;
+    }
+    tokens.clear();
+    tokens.reserve(estimateTokenCount(source.size(), options.emitTypes));
+    Lexer(source, options).drain(tokens);
+}
+
+std::vector<TokenView> tokenize_view(std::string_view source, const LexOptions &options) {
+    std::vector<TokenView> tokens;
+    tokenize_view(source, tokens, options);
+    return tokens;
+}
+
+void tokenize_view(std::string_view source, std::vector<TokenView> &tokens,
+                   std::vector<LexerSnapshot> &lineSnapshots, const LexOptions &options) {
+    tokens.clear();
+    tokens.reserve(estimateTokenCount(source.size(), options.emitTypes));
+    lineSnapshots.clear();
+
+    Lexer lexer(source, options);
+    lineSnapshots.push_back(lexer.snapshot());
+    for (size_t i = source.find('\n'); i != std::string_view::npos; i = source.find('\n', i + 1)) {
+        lexer.drainUntil((int) i + 1, tokens);
+        lineSnapshots.push_back(lexer.snapshot());
+    }
+    lexer.drain(tokens);
+}
+
+std::vector<TokenView> tokenizeRange(std::string_view source, int startLine, int endLine,
+                                     const std::vector<LexerSnapshot> &lineSnapshots,
+                                     const LexOptions &options) {
+    int lineCount = (int) lineSnapshots.size();
+    startLine = std::max(startLine, 1);
+    endLine = std::min(endLine, lineCount + 1);
+    std::vector<TokenView> tokens;
+    if (startLine >= endLine) {
+        return tokens;
+    }
+
+    // Tokens that start before the end of the range overlap it, since the lexer is never inside
+    // a token at a line start, except for a block comment or text block that started above `startLine`.
+    int end = endLine <= lineCount ? lineSnapshots[endLine - 1].position.index : (int) source.size();
+    Lexer lexer(source, lineSnapshots[startLine - 1], options);
+    while (auto token = lexer.next()) {
+        if (token->position.index >= end) {
+            break;
         }
+        tokens.push_back(*token);
     }
+    return tokens;
+}
 
+void tokenize(const std::string &source, std::vector<Token> &tokens, const LexOptions &options) {
+    tokens.reserve(estimateTokenCount(source.size(), options.emitTypes));
+    size_t count = 0;
+    auto store = [&](const TokenView &token) {
+        if (count < tokens.size()) {
+            // Overwrite a token of the previous call, reusing the buffer of its lexeme.
+            Token &reused = tokens[count];
+            reused.type = token.type;
+            reused.lexeme.assign(token.lexeme);
+            reused.position = token.position;
+            reused.id = token.id;
+            reused.numberKind = token.numberKind;
+            reused.numberOverflow = token.numberOverflow;
+            reused.number = token.number;
+        } else {
+            tokens.emplace_back(token);
+        }
+        count++;
+    };
+    if (options.engine == LexerEngine::DFA) {
+        std::vector<TokenView> views;
+        tokenizeDfa(source, views, options);
+        std::for_each(views.begin(), views.end(), store);
+    } else {
+        for (const TokenView &token: Lexer(source, options)) {
+            store(token);
+        }
+    }
+    tokens.erase(tokens.begin() + (long) count, tokens.end());
+}
+
+std::vector<Token> tokenize(const std::string &source, const LexOptions &options) {
+    std::vector<Token> tokens;
+    tokenize(source, tokens, options);
     return tokens;
-}
\ No newline at end of file
+}
+
+TokenizedFile tokenizeFile(const std::string &path) {
+    SourceFile source(path);
+    std::vector<TokenView> tokens = tokenize_view(source.contents());
+    return {std::move(source), std::move(tokens)};
+}
+
+OwnedTokens tokenizeOwned(std::string_view source, const LexOptions &options) {
+    OwnedTokens result;
+    tokenize_view(source, result.tokens, options);
+
+    // Size the arena exactly, so all lexemes go into one block.
+    size_t bytes = 0;
+    for (const TokenView &token: result.tokens) {
+        bytes += token.lexeme.size();
+    }
+    result.lexemes.reserve(bytes);
+    for (TokenView &token: result.tokens) {
+        token.lexeme = result.lexemes.copy(token.lexeme);
+    }
+    return result;
+}
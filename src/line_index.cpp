@@ -0,0 +1,49 @@
+#include "../include/line_index.h"
+#include <algorithm>
+#include <cstring>
+
+LineIndex::LineIndex(std::string_view source) {
+    const char *begin = source.data();
+    const char *end = begin + source.size();
+    for (const char *it = begin; it < end;) {
+        auto newline = (const char *) std::memchr(it, '\n', end - it);
+        if (newline == nullptr) {
+            break;
+        }
+        lineStarts.push_back((uint32_t) (newline - begin) + 1);
+        it = newline + 1;
+    }
+}
+
+struct Position positionInLines(std::span<const uint32_t> lineStarts, uint32_t offset) {
+    // The line is the last one that starts at or before `offset`.
+    auto line = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+    return {
+            .index = (int) offset,
+            .line = (int) (line - lineStarts.begin()) + 1,
+            .column = (int) (offset - *line) + 1
+    };
+}
+
+void LineIndex::edit(uint32_t offset, uint32_t removed, std::string_view inserted) {
+    // Lines starting in (offset, offset + removed] started after a removed newline.
+    auto first = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    auto last = std::upper_bound(first, lineStarts.end(), offset + removed);
+    auto delta = (uint32_t) (inserted.size() - removed);
+    for (auto it = last; it != lineStarts.end(); ++it) {
+        *it += delta;
+    }
+
+    std::vector<uint32_t> added;
+    for (size_t i = inserted.find('\n'); i != std::string_view::npos; i = inserted.find('\n', i + 1)) {
+        added.push_back(offset + (uint32_t) i + 1);
+    }
+    auto position = lineStarts.erase(first, last);
+    lineStarts.insert(position, added.begin(), added.end());
+}
+
+void LineIndex::resolve(std::span<TokenView> tokens) const {
+    for (TokenView &token: tokens) {
+        token.position = position((uint32_t) token.position.index);
+    }
+}
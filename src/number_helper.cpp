@@ -1,17 +1,16 @@
 #include "../include/number_helper.h"
+#include "../include/char_class.h"
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
 
 bool isNumber(char c) {
-    return c >= '0' && c <= '9';
+    return hasCharClass(c, CHAR_DIGIT);
 }
 
 bool isHexOrBinaryNumber(char c, bool binary) {
-    if (binary) {
-        return c == '0' || c == '1';
-    } else {
-        return isNumber(c) ||
-               (c >= 'a' && c <= 'f') ||
-               (c >= 'A' && c <= 'F');
-    }
+    return hasCharClass(c, binary ? CHAR_BINARY_DIGIT : CHAR_HEX_DIGIT);
 }
 
 bool isNumberTypeIdentifier(char c, bool supportsLong) {
@@ -32,30 +31,128 @@ bool isNumberInRange(char c, bool isBinary, bool isHex) {
     }
 }
 
-std::string consumeUnderscoreInNumber(
-        const std::string &source,
+std::string_view consumeUnderscoreInNumber(
+        std::string_view source,
         int index,
         bool isBinary,
         bool isHex
 ) {
-    if (index == 0 || source[index] != '_') {
-        return "";
+    if (index == 0 || index >= source.length() || source[index] != '_') {
+        return {};
     }
     if (!isNumberInRange(source[index - 1], isBinary, isHex)) {
-        return "";
+        return {};
     }
-    std::string consumedString{source[index]};
     int nextIndex = index + 1;
     while (nextIndex < source.length()) {
         if (source[nextIndex] == '_') {
-            consumedString += '_';
             nextIndex++;
         } else if (isNumberInRange(source[nextIndex], isBinary, isHex)) {
-            consumedString += source[nextIndex];
-            return consumedString;
+            return source.substr(index, nextIndex - index + 1);
         } else {
-            return "";
+            return {};
+        }
+    }
+    return {};
+}
+/**
+ * Computes the value of an integer literal from its digits, without prefix, suffix or underscores.
+ */
+NumberLiteral parseIntegerLiteral(std::string_view digits, int base, bool isLong) {
+    uint64_t value = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value, base);
+    if (digits.empty() || end != digits.data() + digits.size()) {
+        return {};
+    }
+
+    NumberLiteral literal = {.kind = isLong ? NumberKind::LONG : NumberKind::INT};
+    if (error == std::errc::result_out_of_range) {
+        // Keep the low 64 bits, which is all a `long` can hold anyway.
+        value = 0;
+        for (char c: digits) {
+            value = value * base + (uint64_t) (isNumber(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        literal.overflow = true;
+    }
+    if (base == 10) {
+        literal.overflow |= value > (uint64_t) (isLong ? INT64_MAX : INT32_MAX);
+        literal.value.integer = (int64_t) value;
+    } else if (isLong) {
+        literal.value.integer = (int64_t) value;
+    } else {
+        literal.overflow |= value > UINT32_MAX;
+        literal.value.integer = (int32_t) (uint32_t) value;
+    }
+    return literal;
+}
+
+/**
+ * Computes the value of a floating-point literal from its digits, without suffix or underscores.
+ * @param digits - The digits, followed by a terminating null character.
+ */
+NumberLiteral parseFloatingLiteral(std::string_view digits, bool isFloat) {
+    const char *begin = digits.data();
+    const char *end = begin + digits.size();
+    NumberLiteral literal = {.kind = isFloat ? NumberKind::FLOAT : NumberKind::DOUBLE};
+    std::from_chars_result result{};
+    if (isFloat) {
+        float value = 0;
+        result = std::from_chars(begin, end, value);
+        literal.value.floating = value;
+    } else {
+        result = std::from_chars(begin, end, literal.value.floating);
+    }
+    if (result.ptr != end) {
+        return {};
+    }
+    if (result.ec == std::errc::result_out_of_range) {
+        // `from_chars` leaves the value unset; `strtod` rounds to infinity or zero instead.
+        literal.overflow = true;
+        literal.value.floating = isFloat ? std::strtof(begin, nullptr) : std::strtod(begin, nullptr);
+    }
+    return literal;
+}
+
+NumberLiteral parseNumberLiteral(TokenType type, std::string_view lexeme) {
+    if (lexeme.empty()) {
+        return {};
+    }
+    char suffix = (char) (lexeme.back() | 0x20);
+    bool hasSuffix = suffix == 'l' || (type == TokenType::NUMBER && (suffix == 'f' || suffix == 'd'));
+    int base = 10;
+    if (type != TokenType::NUMBER) {
+        base = type == TokenType::HEX_NUMBER ? 16 : 2;
+        lexeme.remove_prefix(2);
+    }
+    if (hasSuffix) {
+        lexeme.remove_suffix(1);
+    }
+
+    // Copy the digits without underscores, followed by a null character for `strtod`.
+    char buffer[128];
+    std::string longBuffer;
+    char *digits = buffer;
+    if (lexeme.size() >= sizeof buffer) {
+        longBuffer.resize(lexeme.size() + 1);
+        digits = longBuffer.data();
+    }
+    size_t size = 0;
+    bool isFloating = hasSuffix && suffix != 'l';
+    for (char c: lexeme) {
+        if (c != '_') {
+            digits[size++] = c;
         }
+        isFloating |= base == 10 && (c == '.' || c == 'e' || c == 'E');
     }
-    return "";
-}
\ No newline at end of file
+    digits[size] = '\0';
+
+    std::string_view text(digits, size);
+    if (isFloating) {
+        return parseFloatingLiteral(text, suffix == 'f');
+    }
+    if (base == 10 && size > 1 && text[0] == '0') {
+        base = 8;
+        text.remove_prefix(1);
+    }
+    return parseIntegerLiteral(text, base, suffix == 'l');
+}
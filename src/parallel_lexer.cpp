@@ -0,0 +1,188 @@
+#include "../include/parallel_lexer.h"
+#include "../include/lexer.h"
+#include "../include/char_class.h"
+#include <algorithm>
+#include <numeric>
+
+/**
+ * A line start inside a segment at which a re-lexing run may rejoin the speculative one.
+ */
+struct Checkpoint {
+    int index;              // Index of the line start.
+    size_t tokenCount;      // Number of speculative tokens emitted before `index`.
+    TokenizerState state;   // Speculative state at `index`.
+    bool mergesWhitespace;  // Whether the speculative run would merge a whitespace at `index`.
+};
+
+/**
+ * A slice of the source lexed by one task.
+ */
+struct Segment {
+    size_t begin;                         // Index of the first character, always a line start.
+    size_t end;                           // Index one past the last character.
+    int line = 1;                         // Line number of `begin`.
+    std::vector<TokenView> tokens;        // Tokens emitted while lexing `[begin, end)`.
+    std::vector<Checkpoint> checkpoints;  // Resync points, in increasing order.
+    LexerSnapshot exit{};                 // State of the lexer at `end`.
+    bool leadingWhitespace = false;       // True if a `WHITESPACE` token at `begin` precedes `tokens`.
+};
+
+/**
+ * Splits the source into segments of about `segmentSize` bytes that start at line starts.
+ */
+std::vector<Segment> splitSegments(std::string_view source, size_t segmentSize) {
+    std::vector<Segment> segments;
+    size_t begin = 0;
+    while (begin < source.size()) {
+        size_t end = source.size();
+        if (source.size() - begin > segmentSize) {
+            size_t newline = source.find('\n', begin + segmentSize);
+            if (newline != std::string_view::npos) {
+                end = newline + 1;
+            }
+        }
+        segments.push_back({.begin = begin, .end = end});
+        begin = end;
+    }
+    return segments;
+}
+
+/**
+ * Returns the state the sequential lexer would have at the start of the segment,
+ * assuming that no token, comment or text block is open there.
+ */
+LexerSnapshot speculativeEntry(const Segment &segment) {
+    int begin = (int) segment.begin;
+    if (begin == 0) {
+        return {
+                .state = STATE_NONE,
+                .position = {0, 1, 1},
+                .prev_c = '\0',
+                .hasEmitted = false,
+                .lastType = TokenType::UNKNOWN,
+        };
+    }
+    return {
+            .state = STATE_NONE,
+            .position = {begin, segment.line, 1},
+            .wordStart = begin,
+            .prev_c = '\n',
+            .hasEmitted = true,
+            .lastType = TokenType::WHITESPACE,
+    };
+}
+
+/**
+ * Lexes a segment from its speculative entry state, recording a checkpoint at the first
+ * line start after every `checkpointInterval` bytes.
+ */
+void lexSegment(std::string_view source, Segment &segment, size_t checkpointInterval) {
+    Lexer lexer(source, speculativeEntry(segment));
+    size_t next = segment.begin;
+    while (segment.end - next > checkpointInterval) {
+        size_t newline = source.find('\n', next + checkpointInterval);
+        if (newline == std::string_view::npos || newline + 1 >= segment.end) {
+            break;
+        }
+        next = newline + 1;
+        lexer.drainUntil((int) next, segment.tokens);
+
+        LexerSnapshot snapshot = lexer.snapshot();
+        segment.checkpoints.push_back({(int) next, segment.tokens.size(),
+                                       snapshot.state, snapshot.mergesWhitespace()});
+    }
+    lexer.drainUntil((int) segment.end, segment.tokens);
+    segment.exit = lexer.snapshot();
+}
+
+/**
+ * Lexes a segment again from its true entry state, which is inside a block comment or a text
+ * block, and reuses the speculative tokens from the first checkpoint where both runs agree.
+ */
+void relexSegment(std::string_view source, Segment &segment, const LexerSnapshot &entry) {
+    Lexer lexer(source, entry);
+    std::vector<TokenView> tokens;
+    for (const Checkpoint &checkpoint: segment.checkpoints) {
+        lexer.drainUntil(checkpoint.index, tokens);
+
+        LexerSnapshot snapshot = lexer.snapshot();
+        if (snapshot.state == STATE_NONE && checkpoint.state == STATE_NONE &&
+            snapshot.mergesWhitespace() == checkpoint.mergesWhitespace) {
+            tokens.insert(tokens.end(), segment.tokens.begin() + (long) checkpoint.tokenCount,
+                          segment.tokens.end());
+            segment.tokens = std::move(tokens);
+            return;
+        }
+    }
+    lexer.drainUntil((int) segment.end, tokens);
+    segment.tokens = std::move(tokens);
+    segment.exit = lexer.snapshot();
+}
+
+/**
+ * Makes the speculative result of a segment match the sequential lexer, given its true entry state.
+ */
+void repairSegment(std::string_view source, Segment &segment, const LexerSnapshot &entry) {
+    if (entry.state != STATE_NONE) {
+        relexSegment(source, segment, entry);
+    } else if (!entry.mergesWhitespace() && isWhitespace(source[segment.begin])) {
+        // The speculative run merged the first whitespace into a preceding `WHITESPACE`
+        // token that does not exist; the rest of the segment is unaffected.
+        segment.leadingWhitespace = true;
+    }
+
+    // The speculative exit only knows about the tokens of this segment.
+    if (!segment.tokens.empty()) {
+        segment.exit.hasEmitted = true;
+        segment.exit.lastType = segment.tokens.back().type;
+    } else if (segment.leadingWhitespace) {
+        segment.exit.hasEmitted = true;
+        segment.exit.lastType = TokenType::WHITESPACE;
+    } else {
+        segment.exit.hasEmitted = entry.hasEmitted;
+        segment.exit.lastType = entry.lastType;
+    }
+}
+
+std::vector<TokenView> tokenizeParallel(std::string_view source, const ParallelOptions &options) {
+    std::vector<Segment> segments = splitSegments(source, std::max<size_t>(options.segmentSize, 1));
+    if (segments.size() < 2) {
+        return tokenize_view(source);
+    }
+    ThreadPool &pool = options.pool != nullptr ? *options.pool : ThreadPool::shared();
+    std::vector<size_t> order(segments.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // Count the lines of every segment, so each one knows its starting line.
+    std::vector<int> newlines(segments.size());
+    pool.run(order, [&](size_t index, unsigned) {
+        const Segment &segment = segments[index];
+        newlines[index] = (int) std::count(source.begin() + (long) segment.begin,
+                                           source.begin() + (long) segment.end, '\n');
+    });
+    for (size_t i = 1; i < segments.size(); i++) {
+        segments[i].line = segments[i - 1].line + newlines[i - 1];
+    }
+
+    size_t interval = std::max<size_t>(options.checkpointInterval, 1);
+    pool.run(order, [&](size_t index, unsigned) {
+        lexSegment(source, segments[index], interval);
+    });
+
+    size_t total = segments[0].tokens.size();
+    for (size_t i = 1; i < segments.size(); i++) {
+        repairSegment(source, segments[i], segments[i - 1].exit);
+        total += segments[i].tokens.size() + segments[i].leadingWhitespace;
+    }
+
+    std::vector<TokenView> tokens;
+    tokens.reserve(total);
+    for (const Segment &segment: segments) {
+        if (segment.leadingWhitespace) {
+            tokens.emplace_back(TokenType::WHITESPACE, source.substr(segment.begin, 1),
+                                Position{(int) segment.begin, segment.line, 1}, 0);
+        }
+        tokens.insert(tokens.end(), segment.tokens.begin(), segment.tokens.end());
+    }
+    return tokens;
+}
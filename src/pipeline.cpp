@@ -0,0 +1,154 @@
+#include "../include/pipeline.h"
+#include "../include/async.h"
+#include "../include/push_lexer.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+/**
+ * The state shared by the coroutines of one `tokenizePipeline` call.
+ */
+struct PipelineRun {
+    std::span<const std::string> paths;
+    const TokenSink &sink;
+    const PipelineOptions &options;
+    FileReader &reader;
+    Channel<TokenBlock> &blocks;
+    std::atomic<size_t> nextFile{0};     // Index of the next file to open.
+    std::atomic<bool> stopped{false};    // True once the sink has failed.
+    std::atomic<size_t> files{0};        // Files lexed to the end.
+    std::atomic<size_t> bytes{0};        // Bytes read from them.
+    size_t tokens = 0;                   // Tokens handed to the sink, only updated by the sink coroutine.
+    size_t blockCount = 0;               // Blocks handed to the sink, likewise.
+    std::mutex errorMutex;               // Guards the fields below.
+    std::exception_ptr error;            // The error of the first file, in path order, that failed.
+    size_t errorFile = 0;                // Index of that file.
+};
+
+/**
+ * Reads and lexes one file, pushing its tokens into the channel in blocks.
+ * The read of the next chunk is started before the current one is lexed.
+ */
+Task lexFile(PipelineRun &run, size_t file) {
+    AsyncFile input(run.paths[file]);
+    size_t chunkSize = std::max<size_t>(run.options.chunkSize, 1);
+    size_t blockSize = std::max<size_t>(run.options.blockSize, 1);
+    std::vector<char> chunks[2] = {std::vector<char>(chunkSize), std::vector<char>(chunkSize)};
+    PushLexer lexer(run.options.lexOptions);
+    TokenBlock block{file};
+    block.tokens.reserve(blockSize);
+    uint64_t offset = 0;
+    int current = 0;
+    // Declared last, so an unwinding coroutine waits for the read before the chunks are freed.
+    std::optional<FileReader::Read> read;
+    read.emplace(run.reader, input, chunks[current].data(), chunkSize, offset);
+
+    while (true) {
+        size_t bytes = co_await *read;
+        if (bytes > 0) {
+            std::string_view chunk(chunks[current].data(), bytes);
+            offset += bytes;
+            current ^= 1;
+            read.emplace(run.reader, input, chunks[current].data(), chunkSize, offset);
+            lexer.feed(chunk);
+        } else {
+            lexer.finish();
+        }
+
+        for (Token &token: lexer.takeTokens()) {
+            block.tokens.push_back(std::move(token));
+            if (block.tokens.size() == blockSize) {
+                TokenBlock next{file, block.first + blockSize};
+                next.tokens.reserve(blockSize);
+                if (!co_await run.blocks.push(std::exchange(block, std::move(next)))) {
+                    co_return;
+                }
+            }
+        }
+        if (bytes == 0) {
+            break;
+        }
+    }
+
+    block.last = true;
+    if (co_await run.blocks.push(std::move(block))) {
+        run.files++;
+        run.bytes += offset;
+    }
+}
+
+/**
+ * Lexes files one after the other until none is left or the sink has failed.
+ * An error of one file is recorded and does not stop the others.
+ */
+Task lexFiles(PipelineRun &run) {
+    while (!run.stopped.load(std::memory_order_relaxed)) {
+        size_t file = run.nextFile++;
+        if (file >= run.paths.size()) {
+            break;
+        }
+        try {
+            co_await lexFile(run, file);
+        } catch (...) {
+            std::lock_guard lock(run.errorMutex);
+            if (!run.error || file < run.errorFile) {
+                run.error = std::current_exception();
+                run.errorFile = file;
+            }
+        }
+    }
+}
+
+/**
+ * Hands the blocks to the sink until the channel is closed and empty.
+ * If the sink throws, the channel is closed, which stops the file coroutines.
+ */
+Task consumeBlocks(PipelineRun &run) {
+    while (std::optional<TokenBlock> block = co_await run.blocks.pop()) {
+        run.tokens += block->tokens.size();
+        run.blockCount++;
+        try {
+            run.sink(*block);
+        } catch (...) {
+            run.stopped = true;
+            run.blocks.close();
+            throw;
+        }
+    }
+}
+
+PipelineStats tokenizePipeline(std::span<const std::string> paths, const TokenSink &sink,
+                               const PipelineOptions &options) {
+    if (paths.empty()) {
+        return {};
+    }
+    size_t openFiles = std::clamp<size_t>(options.openFiles, 1, paths.size());
+
+    Executor executor(options.threads);
+    // Every open file has at most one read in flight.
+    FileReader reader(executor, (unsigned) openFiles, options.useIoUring);
+    Channel<TokenBlock> blocks(options.queuedBlocks, executor);
+    PipelineRun run{paths, sink, options, reader, blocks};
+
+    TaskGroup consumer(executor);
+    TaskGroup producers(executor);
+    consumer.spawn(consumeBlocks(run));
+    for (size_t i = 0; i < openFiles; i++) {
+        producers.spawn(lexFiles(run));
+    }
+    producers.wait();
+    blocks.close();
+    consumer.wait();
+    if (run.error) {
+        std::rethrow_exception(run.error);
+    }
+
+    PipelineStats stats;
+    stats.files = run.files;
+    stats.bytes = run.bytes;
+    stats.tokens = run.tokens;
+    stats.blocks = run.blockCount;
+    stats.usedIoUring = reader.usesIoUring();
+    return stats;
+}
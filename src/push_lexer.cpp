@@ -0,0 +1,39 @@
+#include "../include/push_lexer.h"
+
+PushLexer::PushLexer(const LexOptions &options) : lexer(std::string_view{}, options) {
+    lexer.hasMoreInput = true;
+}
+
+void PushLexer::feed(std::string_view chunk) {
+    // Offsets are taken before the buffer changes, since appending may reallocate it.
+    long keepFrom = lexer.retainedOffset();
+    long wordOffset = lexer.word.empty() ? 0 : lexer.word.data() - buffer.data();
+
+    // Only compact once at least half of the buffer has been lexed,
+    // so erasing stays amortized O(1) per input byte.
+    int dropped = keepFrom > 0 && keepFrom >= (long) buffer.size() / 2 ? (int) keepFrom : 0;
+    buffer.erase(0, dropped);
+    buffer.append(chunk);
+    lexer.rebind(buffer, dropped, wordOffset);
+
+    lexAvailable();
+}
+
+void PushLexer::finish() {
+    lexer.hasMoreInput = false;
+    if (!lexer.canStep()) {
+        // The last character was already lexed, so only the pending token is left to finalize.
+        lexer.finishSource();
+    }
+    lexAvailable();
+}
+
+std::vector<Token> PushLexer::takeTokens() {
+    return std::move(tokens);
+}
+
+void PushLexer::lexAvailable() {
+    while (auto token = lexer.next()) {
+        tokens.emplace_back(*token);
+    }
+}
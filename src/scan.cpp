@@ -0,0 +1,373 @@
+#include "../include/scan.h"
+#include <cstdint>
+
+// The vector kernels use GCC/Clang builtins; other compilers get the scalar kernels.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLEJAVALEXER_SCAN_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLEJAVALEXER_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * Checks if a character is whitespace other than a newline.
+ */
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/**
+ * Checks if the character at `i` may end a block comment.
+ */
+inline bool isBlockCommentEnd(const char *data, size_t i) {
+    return data[i] == '\n' || (data[i] == '/' && data[i - 1] == '*');
+}
+
+/**
+ * Checks if a character stops the scan of a text block.
+ */
+inline bool isTextBlockStop(char c) {
+    return c == '"' || c == '\\' || c == '\n';
+}
+
+/**
+ * The scanners of one instruction set. All take the scanned text as `data` and `size`.
+ */
+struct ScanKernels {
+    const char *name;
+    size_t (*until)(const char *data, size_t size, size_t from, char a, char b);
+    size_t (*blockComment)(const char *data, size_t size, size_t from);
+    size_t (*textBlock)(const char *data, size_t size, size_t from);
+    size_t (*blanks)(const char *data, size_t size, size_t from);
+};
+
+// Scalar kernels, also used for the tails of the vector kernels.
+
+size_t scalarUntil(const char *data, size_t size, size_t from, char a, char b) {
+    for (size_t i = from; i < size; i++) {
+        if (data[i] == a || data[i] == b) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t scalarBlockComment(const char *data, size_t size, size_t from) {
+    for (size_t i = from; i < size; i++) {
+        if (isBlockCommentEnd(data, i)) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t scalarTextBlock(const char *data, size_t size, size_t from) {
+    for (size_t i = from; i < size; i++) {
+        if (isTextBlockStop(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t scalarBlanks(const char *data, size_t size, size_t from) {
+    for (size_t i = from; i < size; i++) {
+        if (!isBlank(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+constexpr ScanKernels scalarKernels = {"scalar", scalarUntil, scalarBlockComment, scalarTextBlock, scalarBlanks};
+
+#ifdef SIMPLEJAVALEXER_SCAN_X86
+
+// SSE2 kernels: 16 bytes per iteration. SSE2 is part of every x86-64 CPU.
+
+__attribute__((target("sse2")))
+inline __m128i sse2Blanks(__m128i chunk) {
+    // '\v', '\f' and '\r' are the consecutive bytes 0x0B-0x0D.
+    __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8(0x0B));
+    __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(2)), shifted);
+    return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))), isControl);
+}
+
+__attribute__((target("sse2")))
+size_t sse2Until(const char *data, size_t size, size_t from, char a, char b) {
+    __m128i first = _mm_set1_epi8(a);
+    __m128i second = _mm_set1_epi8(b);
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, first), _mm_cmpeq_epi8(chunk, second));
+        auto mask = (unsigned) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarUntil(data, size, i, a, b);
+}
+
+__attribute__((target("sse2")))
+size_t sse2BlockComment(const char *data, size_t size, size_t from) {
+    __m128i slash = _mm_set1_epi8('/');
+    __m128i star = _mm_set1_epi8('*');
+    __m128i newline = _mm_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i previous = _mm_loadu_si128((const __m128i *) (data + i - 1));
+        __m128i closing = _mm_and_si128(_mm_cmpeq_epi8(chunk, slash), _mm_cmpeq_epi8(previous, star));
+        __m128i match = _mm_or_si128(closing, _mm_cmpeq_epi8(chunk, newline));
+        auto mask = (unsigned) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarBlockComment(data, size, i);
+}
+
+__attribute__((target("sse2")))
+size_t sse2TextBlock(const char *data, size_t size, size_t from) {
+    __m128i quote = _mm_set1_epi8('"');
+    __m128i backslash = _mm_set1_epi8('\\');
+    __m128i newline = _mm_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                     _mm_cmpeq_epi8(chunk, newline));
+        auto mask = (unsigned) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarTextBlock(data, size, i);
+}
+
+__attribute__((target("sse2")))
+size_t sse2SkipBlanks(const char *data, size_t size, size_t from) {
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (data + i));
+        auto mask = (unsigned) _mm_movemask_epi8(sse2Blanks(chunk)) ^ 0xFFFFu;
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarBlanks(data, size, i);
+}
+
+constexpr ScanKernels sse2Kernels = {"sse2", sse2Until, sse2BlockComment, sse2TextBlock, sse2SkipBlanks};
+
+// AVX2 kernels: 32 bytes per iteration, only used if the CPU supports AVX2.
+
+__attribute__((target("avx2")))
+inline __m256i avx2Blanks(__m256i chunk) {
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(0x0B));
+    __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(2)), shifted);
+    return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                                           _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))), isControl);
+}
+
+__attribute__((target("avx2")))
+size_t avx2Until(const char *data, size_t size, size_t from, char a, char b) {
+    __m256i first = _mm256_set1_epi8(a);
+    __m256i second = _mm256_set1_epi8(b);
+    size_t i = from;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) (data + i));
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, first), _mm256_cmpeq_epi8(chunk, second));
+        auto mask = (unsigned) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return sse2Until(data, size, i, a, b);
+}
+
+__attribute__((target("avx2")))
+size_t avx2BlockComment(const char *data, size_t size, size_t from) {
+    __m256i slash = _mm256_set1_epi8('/');
+    __m256i star = _mm256_set1_epi8('*');
+    __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) (data + i));
+        __m256i previous = _mm256_loadu_si256((const __m256i *) (data + i - 1));
+        __m256i closing = _mm256_and_si256(_mm256_cmpeq_epi8(chunk, slash), _mm256_cmpeq_epi8(previous, star));
+        __m256i match = _mm256_or_si256(closing, _mm256_cmpeq_epi8(chunk, newline));
+        auto mask = (unsigned) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return sse2BlockComment(data, size, i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2TextBlock(const char *data, size_t size, size_t from) {
+    __m256i quote = _mm256_set1_epi8('"');
+    __m256i backslash = _mm256_set1_epi8('\\');
+    __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) (data + i));
+        __m256i match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                                        _mm256_cmpeq_epi8(chunk, backslash)),
+                                        _mm256_cmpeq_epi8(chunk, newline));
+        auto mask = (unsigned) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return sse2TextBlock(data, size, i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2SkipBlanks(const char *data, size_t size, size_t from) {
+    size_t i = from;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *) (data + i));
+        auto mask = ~(unsigned) _mm256_movemask_epi8(avx2Blanks(chunk));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return sse2SkipBlanks(data, size, i);
+}
+
+constexpr ScanKernels avx2Kernels = {"avx2", avx2Until, avx2BlockComment, avx2TextBlock, avx2SkipBlanks};
+
+#endif
+
+#ifdef SIMPLEJAVALEXER_SCAN_NEON
+
+// NEON kernels: 16 bytes per iteration. NEON has no movemask, so a match vector is
+// narrowed to 4 bits per byte, and the first match is the lowest set nibble.
+
+inline uint64_t neonMask(uint8x16_t match) {
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+}
+
+size_t neonUntil(const char *data, size_t size, size_t from, char a, char b) {
+    uint8x16_t first = vdupq_n_u8((uint8_t) a);
+    uint8x16_t second = vdupq_n_u8((uint8_t) b);
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *) (data + i));
+        uint64_t mask = neonMask(vorrq_u8(vceqq_u8(chunk, first), vceqq_u8(chunk, second)));
+        if (mask != 0) {
+            return i + __builtin_ctzll(mask) / 4;
+        }
+    }
+    return scalarUntil(data, size, i, a, b);
+}
+
+size_t neonBlockComment(const char *data, size_t size, size_t from) {
+    uint8x16_t slash = vdupq_n_u8('/');
+    uint8x16_t star = vdupq_n_u8('*');
+    uint8x16_t newline = vdupq_n_u8('\n');
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *) (data + i));
+        uint8x16_t previous = vld1q_u8((const uint8_t *) (data + i - 1));
+        uint8x16_t closing = vandq_u8(vceqq_u8(chunk, slash), vceqq_u8(previous, star));
+        uint64_t mask = neonMask(vorrq_u8(closing, vceqq_u8(chunk, newline)));
+        if (mask != 0) {
+            return i + __builtin_ctzll(mask) / 4;
+        }
+    }
+    return scalarBlockComment(data, size, i);
+}
+
+size_t neonTextBlock(const char *data, size_t size, size_t from) {
+    uint8x16_t quote = vdupq_n_u8('"');
+    uint8x16_t backslash = vdupq_n_u8('\\');
+    uint8x16_t newline = vdupq_n_u8('\n');
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *) (data + i));
+        uint8x16_t match = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                    vceqq_u8(chunk, newline));
+        uint64_t mask = neonMask(match);
+        if (mask != 0) {
+            return i + __builtin_ctzll(mask) / 4;
+        }
+    }
+    return scalarTextBlock(data, size, i);
+}
+
+size_t neonSkipBlanks(const char *data, size_t size, size_t from) {
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *) (data + i));
+        uint8x16_t isControl = vcleq_u8(vsubq_u8(chunk, vdupq_n_u8(0x0B)), vdupq_n_u8(2));
+        uint8x16_t blank = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(' ')),
+                                             vceqq_u8(chunk, vdupq_n_u8('\t'))), isControl);
+        uint64_t mask = ~neonMask(blank);
+        if (mask != 0) {
+            return i + __builtin_ctzll(mask) / 4;
+        }
+    }
+    return scalarBlanks(data, size, i);
+}
+
+constexpr ScanKernels neonKernels = {"neon", neonUntil, neonBlockComment, neonTextBlock, neonSkipBlanks};
+
+#endif
+
+/**
+ * Selects the widest kernel the CPU supports.
+ */
+const ScanKernels &selectKernels() {
+#if defined(SIMPLEJAVALEXER_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2Kernels;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return sse2Kernels;
+    }
+#elif defined(SIMPLEJAVALEXER_SCAN_NEON)
+    return neonKernels;
+#endif
+    return scalarKernels;
+}
+
+const ScanKernels &kernels() {
+    static const ScanKernels &selected = selectKernels();
+    return selected;
+}
+
+size_t scanUntil(std::string_view text, size_t from, char a, char b) {
+    return kernels().until(text.data(), text.size(), from, a, b);
+}
+
+size_t scanBlockComment(std::string_view text, size_t from, char prev_c) {
+    if (from >= text.size()) {
+        return text.size();
+    }
+    char c = text[from];
+    if (c == '\n' || (c == '/' && prev_c == '*')) {
+        return from;
+    }
+    // From here on the previous character is always inside `text`.
+    return kernels().blockComment(text.data(), text.size(), from + 1);
+}
+
+size_t scanTextBlock(std::string_view text, size_t from) {
+    return kernels().textBlock(text.data(), text.size(), from);
+}
+
+size_t skipBlanks(std::string_view text, size_t from) {
+    return kernels().blanks(text.data(), text.size(), from);
+}
+
+std::string_view scanKernelName() {
+    return kernels().name;
+}
@@ -0,0 +1,194 @@
+#include "../include/sjl.h"
+#include "../include/lexer.h"
+#include "../include/token_buffer.h"
+#include "../include/token_stream.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <ranges>
+#include <streambuf>
+#include <vector>
+
+/**
+ * The token types of the C interface, in the order of `TokenType`.
+ */
+constexpr int c_token_types[] = {
+    SJL_KEYWORD,
+    SJL_LINE_COMMENT,
+    SJL_BLOCK_COMMENT,
+    SJL_STRING,
+    SJL_CHAR,
+    SJL_IDENTIFIER,
+    SJL_ANNOTATION,
+    SJL_NUMBER,
+    SJL_HEX_NUMBER,
+    SJL_BINARY_NUMBER,
+    SJL_OPERATOR,
+    SJL_SYMBOL,
+    SJL_WHITESPACE,
+    SJL_CONTEXTUAL_KEYWORD,
+    SJL_TEXT_BLOCK,
+    SJL_UNKNOWN,
+};
+
+static_assert(std::size(c_token_types) == TokenType::UNKNOWN + 1 &&
+              std::ranges::equal(c_token_types, std::views::iota(0, TokenType::UNKNOWN + 1)),
+              "The token types of the C interface must match TokenType");
+static_assert(SJL_ENGINE_STATE_MACHINE == (int) LexerEngine::STATE_MACHINE && SJL_ENGINE_DFA == (int) LexerEngine::DFA,
+              "The engines of the C interface must match LexerEngine");
+
+struct sjl_lexer {
+    LexOptions options;              // Options of every call, apart from `trackPositions`.
+    std::vector<TokenView> tokens;   // Tokens of the last source.
+    bool hasPositions = false;       // True if `tokens` have lines and columns.
+    std::vector<uint64_t> stream;    // The last token stream, in 8-byte words for its alignment.
+};
+
+/**
+ * An output buffer writing into a fixed block of memory.
+ */
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(char *data, size_t size) {
+        setp(data, data + size);
+    }
+};
+
+/**
+ * Runs the body of an interface function, turning exceptions into status codes.
+ */
+template<typename Body>
+sjl_status guarded(Body body) {
+    try {
+        return body();
+    } catch (const std::bad_alloc &) {
+        return SJL_ERROR_MEMORY;
+    } catch (...) {
+        return SJL_ERROR_INTERNAL;
+    }
+}
+
+/**
+ * Checks the source of a call and lexes it into the handle's tokens.
+ */
+sjl_status lexInto(sjl_lexer *lexer, const char *source, size_t length, bool trackPositions) {
+    if (lexer == nullptr || (source == nullptr && length > 0)) {
+        return SJL_ERROR_ARGUMENT;
+    }
+    // Token positions are `int` indices.
+    if (length > (size_t) std::numeric_limits<int32_t>::max()) {
+        return SJL_ERROR_TOO_LARGE;
+    }
+    LexOptions options = lexer->options;
+    options.trackPositions = trackPositions;
+    lexer->hasPositions = trackPositions;
+    tokenize_view(std::string_view(source == nullptr ? "" : source, length), lexer->tokens, options);
+    return SJL_OK;
+}
+
+uint32_t sjl_api_version(void) {
+    return SJL_API_VERSION;
+}
+
+sjl_lexer *sjl_lexer_create(const sjl_options *options) {
+    sjl_options defaults{};
+    const sjl_options &chosen = options != nullptr ? *options : defaults;
+    if ((chosen.emit_types & ~all_token_types) != 0 || chosen.engine > SJL_ENGINE_DFA) {
+        return nullptr;
+    }
+    auto *lexer = new(std::nothrow) sjl_lexer;
+    if (lexer != nullptr) {
+        lexer->options.emitTypes = chosen.emit_types != 0 ? chosen.emit_types : all_token_types;
+        lexer->options.engine = (LexerEngine) chosen.engine;
+    }
+    return lexer;
+}
+
+void sjl_free(sjl_lexer *lexer) {
+    delete lexer;
+}
+
+sjl_status sjl_tokenize_into(sjl_lexer *lexer, const char *source, size_t length, sjl_tokens *out) {
+    return guarded([&] {
+        if (out == nullptr) {
+            return SJL_ERROR_ARGUMENT;
+        }
+        sjl_status status = lexInto(lexer, source, length, out->lines != nullptr || out->columns != nullptr);
+        return status == SJL_OK ? sjl_copy_tokens(lexer, out) : status;
+    });
+}
+
+sjl_status sjl_copy_tokens(const sjl_lexer *lexer, sjl_tokens *out) {
+    if (lexer == nullptr || out == nullptr) {
+        return SJL_ERROR_ARGUMENT;
+    }
+    bool hasArrays = out->types != nullptr && out->offsets != nullptr && out->lengths != nullptr;
+    bool wantsPositions = out->lines != nullptr || out->columns != nullptr;
+    if ((out->capacity > 0 && !hasArrays) || (wantsPositions && !lexer->hasPositions)) {
+        return SJL_ERROR_ARGUMENT;
+    }
+    const std::vector<TokenView> &tokens = lexer->tokens;
+    out->count = tokens.size();
+    if (tokens.size() > out->capacity) {
+        return SJL_ERROR_CAPACITY;
+    }
+    for (size_t i = 0; i < tokens.size(); i++) {
+        out->types[i] = (uint8_t) tokens[i].type;
+        out->offsets[i] = (uint32_t) tokens[i].position.index;
+        out->lengths[i] = (uint32_t) tokens[i].lexeme.size();
+    }
+    if (out->lines != nullptr) {
+        for (size_t i = 0; i < tokens.size(); i++) {
+            out->lines[i] = (uint32_t) tokens[i].position.line;
+        }
+    }
+    if (out->columns != nullptr) {
+        for (size_t i = 0; i < tokens.size(); i++) {
+            out->columns[i] = (uint32_t) tokens[i].position.column;
+        }
+    }
+    return SJL_OK;
+}
+
+sjl_status sjl_tokenize_stream(sjl_lexer *lexer, const char *source, size_t length,
+                               const uint8_t **data, size_t *size) {
+    return guarded([&] {
+        if (data == nullptr || size == nullptr) {
+            return SJL_ERROR_ARGUMENT;
+        }
+        // Positions are resolved from the line starts of the stream instead.
+        sjl_status status = lexInto(lexer, source, length, false);
+        if (status != SJL_OK) {
+            return status;
+        }
+        TokenBuffer buffer(std::string_view(source == nullptr ? "" : source, length));
+        buffer.reserve(lexer->tokens.size());
+        for (const TokenView &token: lexer->tokens) {
+            buffer.push_back(token);
+        }
+
+        TokenBufferView view = buffer;
+        size_t bytes = sizeof(TokenStreamHeader) + view.size() * 9 + view.getLineStarts().size_bytes();
+        lexer->stream.resize((bytes + 7) / 8);
+        MemoryBuffer memory((char *) lexer->stream.data(), bytes);
+        std::ostream out(&memory);
+        writeTokenStream(view, out);
+        *data = (const uint8_t *) lexer->stream.data();
+        *size = bytes;
+        return SJL_OK;
+    });
+}
+
+size_t sjl_estimate_token_count(const sjl_lexer *lexer, size_t length) {
+    return estimateTokenCount(length, lexer != nullptr ? lexer->options.emitTypes : all_token_types);
+}
+
+const char *sjl_token_type_name(uint32_t type) {
+    if (type > TokenType::UNKNOWN) {
+        return "UNKNOWN";
+    }
+    // The names are string literals, so they are null-terminated.
+    return getTokenTypeName((TokenType) type).data();
+}
@@ -0,0 +1,105 @@
+#include "../include/source_file.h"
+#include <cerrno>
+#include <cstdio>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIMPLEJAVALEXER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef SIMPLEJAVALEXER_HAS_MMAP
+
+SourceFile::SourceFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "Cannot stat " + path);
+    }
+
+    size = (size_t) info.st_size;
+    if (size > 0) {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "Cannot map " + path);
+        }
+        // The lexer reads the file front to back exactly once.
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = (const char *) mapping;
+        mapped = true;
+    }
+    close(fd);
+}
+
+#else
+
+SourceFile::SourceFile(const std::string &path) {
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (length < 0) {
+        std::fclose(file);
+        throw std::system_error(EIO, std::generic_category(), "Cannot read " + path);
+    }
+
+    size = (size_t) length;
+    buffer = std::make_unique<char[]>(size + 1);
+    if (std::fread(buffer.get(), 1, size, file) != size) {
+        std::fclose(file);
+        throw std::system_error(EIO, std::generic_category(), "Cannot read " + path);
+    }
+    std::fclose(file);
+    data = buffer.get();
+}
+
+#endif
+
+SourceFile::SourceFile(SourceFile &&other) noexcept
+        : data(std::exchange(other.data, nullptr)),
+          size(std::exchange(other.size, 0)),
+          mapped(std::exchange(other.mapped, false)),
+          buffer(std::move(other.buffer)) {}
+
+SourceFile &SourceFile::operator=(SourceFile &&other) noexcept {
+    if (this != &other) {
+        release();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        mapped = std::exchange(other.mapped, false);
+        buffer = std::move(other.buffer);
+    }
+    return *this;
+}
+
+SourceFile::~SourceFile() {
+    release();
+}
+
+void SourceFile::release() {
+#ifdef SIMPLEJAVALEXER_HAS_MMAP
+    if (mapped) {
+        munmap((void *) data, size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.reset();
+}
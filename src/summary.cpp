@@ -0,0 +1,209 @@
+#include "../include/summary.h"
+#include "../include/lexer.h"
+#include <cstring>
+
+/**
+ * Classifies the lines of a source from the lines its tokens span, which arrive in order.
+ */
+struct LineTally {
+    int line = 0;             // The last line any token has touched.
+    bool hasCode = false;     // True if that line has code.
+    bool hasComment = false;  // True if that line has a comment.
+    size_t codeLines = 0;     // Lines before `line` with code.
+    size_t commentLines = 0;  // Lines before `line` with comments only.
+
+    /**
+     * Records a token spanning lines `first` to `last`.
+     */
+    void mark(int first, int last, bool isCode) {
+        if (first == line) {
+            (isCode ? hasCode : hasComment) = true;
+            if (++first > last) {
+                return;
+            }
+        }
+        finish();
+        // The lines after the first one up to the last one hold nothing but the token.
+        (isCode ? codeLines : commentLines) += last - first;
+        line = last;
+        hasCode = isCode;
+        hasComment = !isCode;
+    }
+
+    /**
+     * Counts the last line touched.
+     */
+    void finish() {
+        if (hasCode) {
+            codeLines++;
+        } else if (hasComment) {
+            commentLines++;
+        }
+        hasCode = hasComment = false;
+    }
+};
+
+/**
+ * Picks the names of package and import declarations out of the significant tokens of a source.
+ */
+struct DeclarationParser {
+    enum class Declaration { NONE, PACKAGE, IMPORT };
+
+    std::string_view source;
+    SourceSummary &summary;
+    Declaration declaration = Declaration::NONE;  // The declaration being parsed.
+    bool isStatic = false;                        // True if it is an `import static`.
+    size_t nameStart = 0;                         // Index of the first token of the name.
+    size_t nameEnd = 0;                           // Index after the last token of the name; 0 before the name.
+
+    /**
+     * Takes the next token that is neither whitespace nor a comment.
+     */
+    void take(const TokenView &token) {
+        if (declaration != Declaration::NONE) {
+            if (continueDeclaration(token)) {
+                return;
+            }
+            declaration = Declaration::NONE;
+        }
+        if (token.type == TokenType::KEYWORD && (token.lexeme == "package" || token.lexeme == "import")) {
+            declaration = token.lexeme == "package" ? Declaration::PACKAGE : Declaration::IMPORT;
+            isStatic = false;
+            nameEnd = 0;
+        }
+    }
+
+    /**
+     * Extends or ends the declaration being parsed.
+     * @return false if the token cannot continue it, so it may start another one.
+     */
+    bool continueDeclaration(const TokenView &token) {
+        auto index = (size_t) token.position.index;
+        bool isNamePart = token.type == TokenType::IDENTIFIER || token.type == TokenType::CONTEXTUAL_KEYWORD ||
+                          token.lexeme == "." || (token.lexeme == "*" && declaration == Declaration::IMPORT);
+        if (isNamePart) {
+            if (nameEnd == 0) {
+                nameStart = index;
+            }
+            nameEnd = index + token.lexeme.size();
+            return true;
+        }
+        if (declaration == Declaration::IMPORT && nameEnd == 0 && !isStatic && token.lexeme == "static") {
+            isStatic = true;
+            return true;
+        }
+        if (token.lexeme == ";" && nameEnd != 0) {
+            std::string_view name = source.substr(nameStart, nameEnd - nameStart);
+            if (declaration == Declaration::PACKAGE) {
+                if (summary.packageName.empty()) {
+                    summary.packageName = name;
+                }
+            } else {
+                if (summary.importCount < summary_import_count) {
+                    summary.imports[summary.importCount] = name;
+                }
+                summary.importCount++;
+                summary.staticImportCount += isStatic;
+            }
+            declaration = Declaration::NONE;
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * Finds the lines of indices that only move forward, measuring every line it passes.
+ * Every line break is found once, by `memchr`.
+ */
+struct LineCursor {
+    std::string_view source;
+    SourceSummary &summary;
+    size_t line = 1;          // Line of `lineStart`.
+    size_t lineStart = 0;     // Index of the first character of the current line.
+    size_t lineEnd = 0;       // Index of the line break ending the current line, or the size of the source.
+
+    LineCursor(std::string_view source, SourceSummary &summary) : source(source), summary(summary) {
+        lineEnd = findLineBreak(0);
+    }
+
+    [[nodiscard]] size_t findLineBreak(size_t from) const {
+        const void *newline = std::memchr(source.data() + from, '\n', source.size() - from);
+        return newline != nullptr ? (const char *) newline - source.data() : source.size();
+    }
+
+    /**
+     * Returns the line of a character at or after the previous one asked for.
+     */
+    int lineOf(size_t index) {
+        while (lineEnd < index) {
+            measure();
+            line++;
+            lineStart = lineEnd + 1;
+            lineEnd = findLineBreak(lineStart);
+        }
+        return (int) line;
+    }
+
+    /**
+     * Measures the current line against the longest one so far.
+     */
+    void measure() {
+        size_t length = lineEnd - lineStart - (lineEnd > lineStart && source[lineEnd - 1] == '\r');
+        if (length > summary.longestLine || summary.longestLineNumber == 0) {
+            summary.longestLine = length;
+            summary.longestLineNumber = line;
+        }
+    }
+
+    /**
+     * Measures the remaining lines and counts them all.
+     */
+    void finish() {
+        if (source.empty()) {
+            return;
+        }
+        lineOf(source.size() - 1);
+        measure();
+        // A line break at the very end does not start another line.
+        summary.lines = line;
+    }
+};
+
+SourceSummary summarize(std::string_view source) {
+    SourceSummary summary;
+    LineCursor lines(source, summary);
+    LineTally tally;
+    DeclarationParser declarations{source, summary};
+
+    // Lines come from the cursor, which is cheaper than tracking positions in the lexer.
+    for (const TokenView &token: Lexer(source, {.trackPositions = false})) {
+        summary.tokenCounts[token.type]++;
+        if (token.type == TokenType::WHITESPACE) {
+            continue;
+        }
+        auto index = (size_t) token.position.index;
+        int first = lines.lineOf(index);
+        int last = first;
+        // Only these tokens can span lines; a line comment ends before its line break.
+        if ((token.type == TokenType::BLOCK_COMMENT || token.type == TokenType::TEXT_BLOCK ||
+             token.type == TokenType::UNKNOWN) && token.lexeme.size() > 1) {
+            last = lines.lineOf(index + token.lexeme.size() - 1);
+        }
+        bool isComment = token.type == TokenType::LINE_COMMENT || token.type == TokenType::BLOCK_COMMENT;
+        tally.mark(first, last, !isComment);
+        if (!isComment) {
+            declarations.take(token);
+        }
+    }
+    tally.finish();
+    lines.finish();
+
+    for (size_t count: summary.tokenCounts) {
+        summary.tokens += count;
+    }
+    summary.codeLines = tally.codeLines;
+    summary.commentLines = tally.commentLines;
+    summary.blankLines = summary.lines - summary.codeLines - summary.commentLines;
+    return summary;
+}
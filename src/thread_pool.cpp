@@ -0,0 +1,125 @@
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::run(std::span<const size_t> order, const Task &task) {
+    if (order.empty()) {
+        return;
+    }
+
+    std::lock_guard runLock(runMutex);
+    for (size_t i = 0; i < order.size(); i++) {
+        Queue &queue = *queues[i % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(order[i]);
+    }
+
+    std::unique_lock lock(stateMutex);
+    body = &task;
+    remaining = order.size();
+    generation++;
+    wakeUp.notify_all();
+    idle.wait(lock, [this] { return remaining == 0 && active == 0; });
+    body = nullptr;
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+/**
+ * Takes the next task for a worker: the front of its own queue,
+ * or the back of another worker's queue once its own is empty.
+ * @return true if a task was taken; false if all queues are empty.
+ */
+bool ThreadPool::takeTask(unsigned worker, size_t &task) {
+    {
+        Queue &own = *queues[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue &victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(unsigned worker) {
+    size_t seenGeneration = 0;
+    while (true) {
+        const Task *task;
+        {
+            std::unique_lock lock(stateMutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            task = body;
+            if (task == nullptr) {
+                // Woke up after the batch already finished.
+                continue;
+            }
+            active++;
+        }
+
+        size_t index;
+        size_t finished = 0;
+        while (takeTask(worker, index)) {
+            // A failed task still finishes, so the batch ends and `run` can rethrow the error.
+            try {
+                (*task)(index, worker);
+            } catch (...) {
+                std::lock_guard lock(stateMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            finished++;
+        }
+
+        std::lock_guard lock(stateMutex);
+        remaining -= finished;
+        active--;
+        if (remaining == 0 && active == 0) {
+            idle.notify_all();
+        }
+    }
+}
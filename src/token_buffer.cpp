@@ -0,0 +1,44 @@
+#include "../include/token_buffer.h"
+#include "../include/lexer.h"
+#include <algorithm>
+#include <ranges>
+
+static_assert(std::ranges::forward_range<TokenBuffer>, "TokenBuffer must be usable as a C++20 range");
+
+TokenBuffer::TokenBuffer(std::string_view source) : source(source), lines(source) {}
+
+TokenBuffer::TokenBuffer(const TokenBufferView &tokens)
+        : source(tokens.source),
+          lines(tokens.lineStarts),
+          types(tokens.types.begin(), tokens.types.end()),
+          offsets(tokens.offsets.begin(), tokens.offsets.end()),
+          lengths(tokens.lengths.begin(), tokens.lengths.end()) {}
+
+void TokenBuffer::reserve(size_t count) {
+    types.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+}
+
+void TokenBuffer::shrink_to_fit() {
+    types.shrink_to_fit();
+    offsets.shrink_to_fit();
+    lengths.shrink_to_fit();
+}
+
+size_t TokenBuffer::memoryUsage() const {
+    return types.capacity() * sizeof(uint8_t) +
+           offsets.capacity() * sizeof(uint32_t) +
+           lengths.capacity() * sizeof(uint32_t) +
+           lines.memoryUsage();
+}
+
+TokenBuffer tokenizeCompact(std::string_view source) {
+    TokenBuffer buffer(source);
+    // Positions are resolved from the line index instead.
+    for (const TokenView &token: Lexer(source, {.trackPositions = false})) {
+        buffer.push_back(token);
+    }
+    buffer.shrink_to_fit();
+    return buffer;
+}
@@ -0,0 +1,113 @@
+#include "../include/token_cache.h"
+#include "../include/content_hash.h"
+#include "../include/token_stream.h"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+TokenCache::TokenCache(TokenCacheOptions options) : options(std::move(options)) {}
+
+TokenBuffer TokenCache::tokenize(std::string_view source) {
+    uint64_t hash = contentHash(source);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(hash);
+        if (it != index.end() && it->second->sourceSize == source.size()) {
+            entries.splice(entries.begin(), entries, it->second);
+            counters.hits++;
+            TokenBuffer tokens = it->second->tokens;
+            tokens.source = source;
+            return tokens;
+        }
+    }
+
+    if (std::optional<TokenBuffer> tokens = load(hash, source)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.diskHits++;
+        insert(hash, source, *tokens);
+        return std::move(*tokens);
+    }
+
+    TokenBuffer tokens = tokenizeCompact(source);
+    store(hash, tokens);
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.misses++;
+    insert(hash, source, tokens);
+    return tokens;
+}
+
+TokenCacheStats TokenCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void TokenCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+/**
+ * Adds an entry as the most recently used one, evicting the least recently used entries
+ * beyond the capacity. Must be called with the mutex held.
+ */
+void TokenCache::insert(uint64_t hash, std::string_view source, const TokenBuffer &tokens) {
+    if (options.capacity == 0) {
+        return;
+    }
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        // Another thread inserted it meanwhile, or a source of another size had the same hash.
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front({hash, source.size(), tokens});
+    entries.front().tokens.source = {};
+    index[hash] = entries.begin();
+    while (entries.size() > options.capacity) {
+        index.erase(entries.back().hash);
+        entries.pop_back();
+    }
+}
+
+std::string TokenCache::entryPath(uint64_t hash) const {
+    char name[32];
+    std::snprintf(name, sizeof name, "%016llx.tokens", (unsigned long long) hash);
+    return (std::filesystem::path(options.directory) / name).string();
+}
+
+std::optional<TokenBuffer> TokenCache::load(uint64_t hash, std::string_view source) const {
+    if (options.directory.empty()) {
+        return std::nullopt;
+    }
+    try {
+        // The entry is copied into the cache, so every token is checked before it is trusted.
+        MappedTokenStream stream = loadTokenStream(entryPath(hash), source, true);
+        if (readTokenStreamHeader(stream.file.contents()).sourceHash != hash) {
+            return std::nullopt;
+        }
+        return TokenBuffer(stream.tokens);
+    } catch (const std::exception &) {
+        // Missing, damaged or outdated entries are misses.
+        return std::nullopt;
+    }
+}
+
+void TokenCache::store(uint64_t hash, const TokenBuffer &tokens) const {
+    if (options.directory.empty()) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(options.directory, error);
+
+    // Write to a unique temporary file and rename it, so that concurrent builds never read
+    // a partially written entry.
+    std::string path = entryPath(hash);
+    std::string temporary = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    try {
+        saveTokenStream(tokens, temporary);
+        std::filesystem::rename(temporary, path);
+    } catch (const std::exception &) {
+        std::filesystem::remove(temporary, error);
+    }
+}
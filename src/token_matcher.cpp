@@ -1,88 +1,86 @@
 #include "../include/token.h"
 #include "../include/token_matcher.h"
-#include <regex>
+#include "../include/char_class.h"
+#include "../include/perfect_hash.h"
+#include "../include/unicode.h"
+#include <algorithm>
 
-// https://en.wikipedia.org/wiki/List_of_Java_keywords
-const std::vector<std::string> java_keywords = {
-        "abstract", "assert", "boolean", "break",
-        "byte", "case", "catch", "char", "class",
-        "continue", "default", "do", "double",
-        "else", "enum", "extends", "final", "if",
-        "finally", "float", "for", "implements",
-        "import", "instanceof", "int", "interface",
-        "long", "native", "new", "package", "private",
-        "protected", "public", "return", "short",
-        "static", "super", "switch", "synchronized",
-        "this", "throw", "throws", "transient", "try",
-        "void", "volatile", "while", "goto", "@interface",
-        "true", "false", "null", "const", "strictfp", "_"
-};
+/**
+ * The strict keywords followed by the contextual ones, so a word is classified with one lookup.
+ */
+constexpr auto all_keywords = [] {
+    std::array<std::string_view, java_keywords.size() + java_contextual_keywords.size()> words{};
+    std::copy(java_keywords.begin(), java_keywords.end(), words.begin());
+    std::copy(java_contextual_keywords.begin(), java_contextual_keywords.end(), words.begin() + java_keywords.size());
+    return words;
+}();
 
-const std::vector<char> java_operators_starter = {
-        '=', '!', '<', '>', '+', '-', '*', '/',
-        '&', '~', '|', '%', '^',
-};
+constexpr PerfectHashSet<all_keywords.size(), 512> keyword_set{all_keywords};
+constexpr PerfectHashSet<java_operators.size(), 128> operator_set{java_operators};
+constexpr PerfectHashSet<java_symbols.size(), 32> symbol_set{java_symbols};
 
-const std::vector<std::string> java_operators = {
-        "<", ">", ">=", "<=",
-        "<<", ">>", "<<=", ">>=",
-        "+", "+=", "++",
-        "-", "-=", "--",
-        "&", "&=", "&&",
-        "|", "|=", "||",
-        "=", "==",
-        "*", "*=",
-        "/", "/=",
-        "%", "%=",
-        "~", "~=",
-        "!", "!=",
-        "^", "^=",
-};
-
-const std::vector<std::string> java_symbols = {
-        ";", "->", "{", "}", "[", "]", "(", ")", ",", "@", ".", "?", ":"
-};
+bool isKeyword(std::string_view token) {
+    return keyword_set.find(token) < java_keywords.size();
+}
 
-const std::regex identifier_letter_regex = std::regex(R"([a-zA-Z0-9_$])");
-const std::regex identifier_regex = std::regex(R"([a-zA-Z_$][a-zA-Z0-9_$]*)");
-const std::regex whitespace_regex = std::regex(R"(\s+)");
+bool isContextualKeyword(std::string_view token) {
+    size_t index = keyword_set.find(token);
+    return index >= java_keywords.size() && index < all_keywords.size();
+}
 
-template<class InputIterator, class Type>
-bool find(std::vector<InputIterator> vector, const Type &value) {
-    return std::find(vector.begin(), vector.end(), value) != vector.end();
+TokenType getWordType(std::string_view word) {
+    size_t index = keyword_set.find(word);
+    if (index < java_keywords.size()) {
+        return KEYWORD;
+    }
+    return index < all_keywords.size() ? CONTEXTUAL_KEYWORD : IDENTIFIER;
 }
 
-bool isKeyword(const std::string &token) {
-    return find(java_keywords, token);
+size_t nonSealedSuffixLength(std::string_view text, size_t index) {
+    constexpr std::string_view suffix = "-sealed";
+    if (text.substr(index, suffix.size()) != suffix) {
+        return 0;
+    }
+    size_t end = index + suffix.size();
+    return end < text.size() && identifierCharLength(text, end, false) > 0 ? 0 : suffix.size();
 }
 
-bool isOperator(const std::string &token) {
-    return find(java_operators, token);
+bool isOperator(std::string_view token) {
+    return operator_set.contains(token);
 }
 
-bool isSymbol(const std::string &token) {
-    return find(java_symbols, token);
+bool isSymbol(std::string_view token) {
+    return symbol_set.contains(token);
 }
 
-bool isIdentifierLetter(const std::string &token) {
-    return std::regex_match(token, identifier_letter_regex);
+bool isIdentifierLetter(std::string_view token) {
+    return !token.empty() && identifierCharLength(token, 0, false) == token.size();
 }
 
-bool isIdentifier(const std::string &token) {
-    return std::regex_match(token, identifier_regex);
+bool isIdentifier(std::string_view token) {
+    if (token.empty()) {
+        return false;
+    }
+    size_t start = isIdentifierStart(token[0]) ? 1 : identifierCharLength(token, 0, true);
+    return start > 0 && skipIdentifierParts(token, start) == token.size();
 }
 
-bool isWhitespace(const std::string &token) {
-    return std::regex_match(token, whitespace_regex);
+bool isWhitespace(std::string_view token) {
+    return !token.empty() && std::all_of(token.begin(), token.end(), [](char c) {
+        return isWhitespace(c);
+    });
 }
 
-bool isOperatorStart(const std::string &token) {
-    return find(java_operators_starter, token[0]);
+bool isOperatorStart(std::string_view token) {
+    return !token.empty() && isOperatorStart(token[0]);
 }
 
-TokenType getTokenType(const std::string &token) {
-    if (isKeyword(token)) {
+TokenType getTokenType(std::string_view token) {
+    size_t keyword = keyword_set.find(token);
+    if (keyword < java_keywords.size()) {
         return KEYWORD;
+    } else if (keyword < all_keywords.size()) {
+        return CONTEXTUAL_KEYWORD;
     } else if (isOperator(token)) {
         return OPERATOR;
     } else if (isIdentifier(token)) {
@@ -92,7 +90,7 @@ TokenType getTokenType(const std::string &token) {
     } else if (isSymbol(token)) {
         return SYMBOL;
     } else if (token[0] == '@') {
-        std::string sub = token.substr(1);
+        std::string_view sub = token.substr(1);
         if (isKeyword(sub) || !isIdentifier(sub)) {
             return UNKNOWN;
         }
@@ -0,0 +1,119 @@
+#include "../include/token_stream.h"
+#include "../include/content_hash.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+static_assert(sizeof(TokenStreamHeader) == 48, "The token stream header must have a fixed layout");
+
+constexpr uint16_t byte_order_mark = 0x0102;
+
+/**
+ * Writes the contents of an array to a binary stream.
+ */
+template<typename T>
+void writeArray(std::ostream &out, std::span<const T> values) {
+    out.write((const char *) values.data(), (std::streamsize) values.size_bytes());
+}
+
+void writeTokenStream(const TokenBufferView &tokens, std::ostream &out) {
+    TokenStreamHeader header = {
+            .magic = {'S', 'J', 'L', 'T'},
+            .version = token_stream_version,
+            .byteOrder = byte_order_mark,
+            .headerSize = sizeof(TokenStreamHeader),
+            .reserved = 0,
+            .sourceSize = tokens.source.size(),
+            .sourceHash = contentHash(tokens.source),
+            .tokenCount = tokens.size(),
+            .lineCount = tokens.lineStarts.size(),
+    };
+    out.write((const char *) &header, sizeof header);
+    writeArray(out, tokens.offsets);
+    writeArray(out, tokens.lengths);
+    writeArray(out, tokens.lineStarts);
+    writeArray(out, tokens.types);
+}
+
+void saveTokenStream(const TokenBufferView &tokens, const std::string &path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+    }
+    writeTokenStream(tokens, file);
+    file.flush();
+    if (!file) {
+        throw std::system_error(errno, std::generic_category(), "Cannot write " + path);
+    }
+}
+
+TokenStreamHeader readTokenStreamHeader(std::string_view bytes) {
+    TokenStreamHeader header{};
+    if (bytes.size() < sizeof header) {
+        throw std::runtime_error("Invalid token stream: truncated header");
+    }
+    std::memcpy(&header, bytes.data(), sizeof header);
+    if (std::string_view(header.magic, 4) != "SJLT") {
+        throw std::runtime_error("Invalid token stream: bad magic");
+    }
+    if (header.version != token_stream_version || header.byteOrder != byte_order_mark ||
+        header.headerSize != sizeof header) {
+        throw std::runtime_error("Invalid token stream: unsupported version or byte order");
+    }
+    return header;
+}
+
+/**
+ * Checks that every token has a valid type and lies within a source of the given size, and so
+ * does every line start.
+ */
+bool tokenArraysFit(size_t sourceSize, std::span<const uint32_t> lineStarts, std::span<const uint8_t> types,
+                    std::span<const uint32_t> offsets, std::span<const uint32_t> lengths) {
+    // Accumulating the failures instead of returning early keeps the loop free of branches.
+    bool fits = true;
+    for (size_t i = 0; i < types.size(); i++) {
+        fits &= types[i] <= TokenType::UNKNOWN && (uint64_t) offsets[i] + lengths[i] <= sourceSize;
+    }
+    for (uint32_t lineStart: lineStarts) {
+        fits &= lineStart <= sourceSize;
+    }
+    return fits;
+}
+
+TokenBufferView readTokenStream(std::string_view bytes, std::string_view source, bool checkTokens) {
+    TokenStreamHeader header = readTokenStreamHeader(bytes);
+    if (header.sourceSize != source.size()) {
+        throw std::runtime_error("Invalid token stream: written for another source");
+    }
+    if ((uintptr_t) bytes.data() % alignof(uint32_t) != 0) {
+        throw std::runtime_error("Invalid token stream: misaligned data");
+    }
+
+    // Sizes are checked one by one, so that huge counts cannot overflow the total.
+    size_t available = bytes.size() - sizeof header;
+    if (header.tokenCount > available / 9 || header.lineCount == 0 ||
+        header.lineCount > (available - header.tokenCount * 9) / 4) {
+        throw std::runtime_error("Invalid token stream: truncated arrays");
+    }
+    auto tokenCount = (size_t) header.tokenCount;
+    auto lineCount = (size_t) header.lineCount;
+    const char *data = bytes.data() + sizeof header;
+    auto offsets = (const uint32_t *) data;
+    auto lengths = offsets + tokenCount;
+    auto lineStarts = lengths + tokenCount;
+    auto types = (const uint8_t *) (lineStarts + lineCount);
+    if (checkTokens && !tokenArraysFit(source.size(), {lineStarts, lineCount}, {types, tokenCount},
+                                       {offsets, tokenCount}, {lengths, tokenCount})) {
+        throw std::runtime_error("Invalid token stream: tokens out of range");
+    }
+    return {source, {lineStarts, lineCount}, {types, tokenCount}, {offsets, tokenCount}, {lengths, tokenCount}};
+}
+
+MappedTokenStream loadTokenStream(const std::string &path, std::string_view source, bool checkTokens) {
+    SourceFile file(path);
+    // The mapping stays at the same address when `file` is moved into the result.
+    TokenBufferView tokens = readTokenStream(file.contents(), source, checkTokens);
+    return {std::move(file), tokens};
+}
@@ -0,0 +1,163 @@
+#include <cstdint>
+#include "../include/unicode.h"
+
+#include "unicode_table.inc"
+
+/**
+ * Looks up a code point above ASCII in one of the bitmaps of `unicode_table.inc`.
+ */
+inline bool hasUnicodeFlag(const uint64_t (&bitmaps)[unicode_block_count][4], char32_t codePoint) {
+    if (codePoint > 0x10FFFF) {
+        return false;
+    }
+    const uint64_t *block = bitmaps[unicode_block_index[codePoint >> 8]];
+    return ((block[(codePoint & 0xFF) >> 6] >> (codePoint & 63)) & 1) != 0;
+}
+
+bool isUnicodeIdentifierStart(char32_t codePoint) {
+    if (codePoint < 0x80) {
+        return isIdentifierStart((char) codePoint);
+    }
+    return hasUnicodeFlag(unicode_identifier_start, codePoint);
+}
+
+bool isUnicodeIdentifierPart(char32_t codePoint) {
+    if (codePoint < 0x80) {
+        return isIdentifierLetter((char) codePoint);
+    }
+    return hasUnicodeFlag(unicode_identifier_part, codePoint);
+}
+
+DecodedChar decodeUtf8(std::string_view text, size_t index) {
+    auto lead = (unsigned char) text[index];
+    size_t length;
+    char32_t codePoint;
+    // The range of the second byte excludes overlong forms, surrogates and code points above U+10FFFF.
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        codePoint = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        codePoint = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        codePoint = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return {};
+    }
+    if (index + length > text.size()) {
+        return {};
+    }
+    for (size_t i = 1; i < length; i++) {
+        auto next = (unsigned char) text[index + i];
+        if (next < low || next > high) {
+            return {};
+        }
+        codePoint = codePoint << 6 | (next & 0x3F);
+        low = 0x80;
+        high = 0xBF;
+    }
+    return {codePoint, length};
+}
+
+/**
+ * Decodes a single escape, without combining surrogate pairs.
+ */
+DecodedChar decodeEscapedUnit(std::string_view text, size_t index) {
+    if (index + 1 >= text.size() || text[index] != '\\' || text[index + 1] != 'u') {
+        return {};
+    }
+    size_t digits = index + 2;
+    while (digits < text.size() && text[digits] == 'u') {
+        digits++;
+    }
+    if (digits + 4 > text.size()) {
+        return {};
+    }
+    char32_t codePoint = 0;
+    for (size_t i = digits; i < digits + 4; i++) {
+        char c = text[i];
+        if (!hasCharClass(c, CHAR_HEX_DIGIT)) {
+            return {};
+        }
+        codePoint = codePoint << 4 | (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return {codePoint, digits + 4 - index};
+}
+
+DecodedChar decodeUnicodeEscape(std::string_view text, size_t index) {
+    DecodedChar unit = decodeEscapedUnit(text, index);
+    if (unit.length == 0 || unit.codePoint < 0xD800 || unit.codePoint > 0xDBFF) {
+        return unit;
+    }
+    DecodedChar low = decodeEscapedUnit(text, index + unit.length);
+    if (low.length == 0 || low.codePoint < 0xDC00 || low.codePoint > 0xDFFF) {
+        return unit;
+    }
+    return {0x10000 + ((unit.codePoint - 0xD800) << 10) + (low.codePoint - 0xDC00), unit.length + low.length};
+}
+
+size_t identifierCharLength(std::string_view text, size_t index, bool isStart) {
+    char c = text[index];
+    if (!isUnicodeStart(c)) {
+        return (isStart ? isIdentifierStart(c) : isIdentifierLetter(c)) ? 1 : 0;
+    }
+    DecodedChar decoded = c == '\\' ? decodeUnicodeEscape(text, index) : decodeUtf8(text, index);
+    if (decoded.length == 0) {
+        return 0;
+    }
+    bool isIdentifierChar = isStart ? isUnicodeIdentifierStart(decoded.codePoint)
+                                    : isUnicodeIdentifierPart(decoded.codePoint);
+    return isIdentifierChar ? decoded.length : 0;
+}
+
+size_t skipIdentifierParts(std::string_view text, size_t from) {
+    size_t index = from;
+    while (index < text.size()) {
+        if (isIdentifierLetter(text[index])) {
+            index++;
+            continue;
+        }
+        size_t length = isUnicodeStart(text[index]) ? identifierCharLength(text, index, false) : 0;
+        if (length == 0) {
+            break;
+        }
+        index += length;
+    }
+    return index;
+}
+
+size_t utf8SequenceLength(std::string_view text, size_t index) {
+    size_t length = decodeUtf8(text, index).length;
+    return length > 0 ? length : 1;
+}
+
+size_t unicodeLookahead(std::string_view text, size_t index) {
+    if (text[index] != '\\') {
+        auto lead = (unsigned char) text[index];
+        return index + (lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1);
+    }
+    // An escape, which may be followed by the escaped low surrogate of a pair.
+    size_t end = index;
+    for (int unit = 0; unit < 2; unit++) {
+        if (end >= text.size() || text[end] != '\\') {
+            return end + 1;
+        }
+        size_t digits = end + 1;
+        while (digits < text.size() && text[digits] == 'u') {
+            digits++;
+        }
+        if (digits >= text.size() || digits == end + 1) {
+            // Either more 'u's may follow, or the byte after the '\' ends the escape.
+            return digits + 1;
+        }
+        end = digits + 4;
+    }
+    return end;
+}
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/sjl.h"
+
+/**
+ * Uses the C interface from C: counts the tokens of a source with empty arrays, then grows the
+ * arrays and copies the tokens without lexing again, as a caller through an FFI would.
+ * Returns NULL if every check passed, or a description of the first one that failed.
+ */
+const char *check_c_api(void) {
+    static const uint8_t expected_types[] = {SJL_KEYWORD, SJL_WHITESPACE, SJL_IDENTIFIER, SJL_SYMBOL};
+    static const uint32_t expected_offsets[] = {0, 3, 6, 7};
+    const char *source = "int\n  x;";
+    const char *failure = NULL;
+
+    if (sjl_api_version() != SJL_API_VERSION) {
+        return "Version of the library";
+    }
+    sjl_options invalid = {0, 7};
+    if (sjl_lexer_create(&invalid) != NULL) {
+        return "Invalid engine accepted";
+    }
+    sjl_lexer *lexer = sjl_lexer_create(NULL);
+    if (lexer == NULL) {
+        return "Create";
+    }
+
+    sjl_tokens tokens = {0};
+    if (sjl_tokenize_into(lexer, source, strlen(source), &tokens) != SJL_ERROR_CAPACITY || tokens.count != 4) {
+        failure = "Count with empty arrays";
+    } else {
+        tokens.capacity = tokens.count;
+        tokens.types = malloc(tokens.capacity);
+        tokens.offsets = malloc(tokens.capacity * sizeof(uint32_t));
+        tokens.lengths = malloc(tokens.capacity * sizeof(uint32_t));
+        if (sjl_copy_tokens(lexer, &tokens) != SJL_OK ||
+            memcmp(tokens.types, expected_types, sizeof expected_types) != 0 ||
+            memcmp(tokens.offsets, expected_offsets, sizeof expected_offsets) != 0 ||
+            tokens.lengths[0] != 3 || tokens.lengths[2] != 1) {
+            failure = "Copy after growing";
+        } else if (strcmp(sjl_token_type_name(tokens.types[2]), "IDENTIFIER") != 0) {
+            failure = "Token type name";
+        } else {
+            // Without positions from the last call, lines cannot be copied.
+            uint32_t lines[4];
+            tokens.lines = lines;
+            if (sjl_copy_tokens(lexer, &tokens) != SJL_ERROR_ARGUMENT) {
+                failure = "Lines without positions";
+            }
+        }
+        free(tokens.types);
+        free(tokens.offsets);
+        free(tokens.lengths);
+    }
+    sjl_free(lexer);
+    return failure;
+}
@@ -1,5 +1,112 @@
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include "assert_lexer.h"
+#include "../include/batch_lexer.h"
+#include "../include/identifier_interner.h"
+#include "../include/incremental_lexer.h"
 #include "../include/lexer.h"
+#include "../include/line_index.h"
+#include "../include/parallel_lexer.h"
+#include "../include/pipeline.h"
+#include "../include/push_lexer.h"
+#include "../include/sjl.h"
+#include "../include/summary.h"
+#include "../include/thread_pool.h"
+#include "../include/token_cache.h"
+#include "../include/token_stream.h"
+#include "../include/token_buffer.h"
+
+/**
+ * A source with tabs, comments after code and a block comment spanning lines, shared by the tests
+ * of the containers that store tokens.
+ */
+constexpr std::string_view multi_line_source =
+        "class A {\n\tint a = b[0]; /* x */ c(a);\n  /* multi\n line */ d::e;\n}";
+
+/**
+ * Checks that view-based tokens match the tokens produced by `tokenize`,
+ * with every lexeme pointing into the input buffer.
+ */
+bool assertViewLexer(
+        const std::string &testName,
+        std::string_view input,
+        const std::vector <Token> &tokens,
+        const std::vector <TokenView> &views
+) {
+    if (views.size() != tokens.size()) {
+        std::cerr << "Test failed (" << testName << "): Produced " << views.size()
+                  << " tokens, expected " << tokens.size() << ".\n";
+        return false;
+    }
+    for (int i = 0; i < views.size(); i++) {
+        const auto &view = views[i];
+        const auto &token = tokens[i];
+        bool isInsideInput = view.lexeme.data() >= input.data() &&
+                             view.lexeme.data() + view.lexeme.size() <= input.data() + input.size();
+        bool isAtIndex = view.lexeme.data() == input.data() + view.position.index;
+        if (view.type != token.type || view.lexeme != token.lexeme || !isInsideInput || !isAtIndex ||
+            view.position.index != token.position.index ||
+            view.position.line != token.position.line ||
+            view.position.column != token.position.column) {
+            std::cerr << "Test failed (" << testName << "): Expected " << token
+                      << ", got " << view << ".\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks that a range of `TokenView`s, e.g. a `TokenBuffer` or a `TokenBufferView`, matches the
+ * tokens produced by `tokenize`, with every lexeme pointing into the input buffer.
+ */
+template<typename Range>
+bool assertTokenViews(const std::string &testName, const std::string &input, const Range &range) {
+    std::vector<TokenView> views(range.begin(), range.end());
+    return assertViewLexer(testName, input, tokenize(input), views);
+}
+
+/**
+ * Checks that feeding the input to a `PushLexer` in chunks of several sizes
+ * produces the same tokens as `tokenize`.
+ */
+bool assertPushLexer(
+        const std::string &testName,
+        const std::string &input,
+        const std::vector <Token> &tokens
+) {
+    for (int chunkSize: {1, 2, 3, 7}) {
+        PushLexer lexer;
+        std::vector<Token> pushed;
+        for (int i = 0; i < input.size(); i += chunkSize) {
+            lexer.feed(std::string_view(input).substr(i, chunkSize));
+            for (auto &token: lexer.takeTokens()) {
+                pushed.push_back(std::move(token));
+            }
+        }
+        lexer.finish();
+        for (auto &token: lexer.takeTokens()) {
+            pushed.push_back(std::move(token));
+        }
+
+        bool isEqual = pushed.size() == tokens.size();
+        for (int i = 0; isEqual && i < tokens.size(); i++) {
+            isEqual = pushed[i].type == tokens[i].type && pushed[i].lexeme == tokens[i].lexeme &&
+                      pushed[i].position.index == tokens[i].position.index &&
+                      pushed[i].position.line == tokens[i].position.line &&
+                      pushed[i].position.column == tokens[i].position.column;
+        }
+        if (!isEqual) {
+            std::cerr << "Test failed (" << testName << "): PushLexer with chunks of " << chunkSize
+                      << " produced different tokens.\n";
+            return false;
+        }
+    }
+    return true;
+}
 
 void assertLexer(
         const std::string &testName,
@@ -7,6 +114,18 @@ void assertLexer(
         const std::vector <Token> &expected
 ) {
     auto tokens = tokenize(input);
+    if (!assertViewLexer(testName, input, tokens, tokenize_view(input))) return;
+
+    std::vector<TokenView> streamed;
+    for (const TokenView &token: Lexer(input)) {
+        streamed.push_back(token);
+    }
+    if (!assertViewLexer(testName + " [Lexer]", input, tokens, streamed)) return;
+    if (!assertViewLexer(testName + " [DFA]", input, tokens, tokenize_view(input, {.engine = LexerEngine::DFA}))) {
+        return;
+    }
+    if (!assertPushLexer(testName, input, tokens)) return;
+
     int index = 0;
     for (const auto &token: tokens) {
         if (token.type == TokenType::WHITESPACE) continue;
@@ -137,6 +256,19 @@ void test_comments() {
             Token(TokenType::BLOCK_COMMENT, "/* This is a \n multi-line comment */"),
             Token(TokenType::IDENTIFIER, "d"),
     });
+
+    std::string body(40, 'x');
+    std::string blanks(40, ' ');
+    assertLexer("Long comments and literals",
+                "/*" + body + "*" + body + "**/" + blanks + "\"" + body + "\\\"" + body + "\"" +
+                "//" + body + "\n" + blanks + "'\\'' /*/" + body + "\n", {
+            Token(TokenType::BLOCK_COMMENT, "/*" + body + "*" + body + "**/"),
+            Token(TokenType::STRING, "\"" + body + "\\\"" + body + "\""),
+            Token(TokenType::LINE_COMMENT, "//" + body),
+            Token(TokenType::CHAR, "'\\''"),
+            Token(TokenType::BLOCK_COMMENT, "/*/"),
+            Token(TokenType::IDENTIFIER, body),
+    });
 }
 
 void test_others() {
@@ -149,6 +281,10 @@ void test_others() {
             Token(TokenType::SYMBOL, "::"),
             Token(TokenType::IDENTIFIER, "b"),
     });
+    assertLexer("Whitespace characters", "a\r\n\v\f\tb", {
+            Token(TokenType::IDENTIFIER, "a"),
+            Token(TokenType::IDENTIFIER, "b"),
+    });
     assertLexer("Invalid characters", "a + #", {
             Token(TokenType::IDENTIFIER, "a"),
             Token(TokenType::OPERATOR, "+"),
@@ -164,6 +300,15 @@ void test_others() {
             Token(TokenType::SYMBOL, "{"),
             Token(TokenType::SYMBOL, "}"),
     });
+    assertLexer("Keyword lookalikes", "throws thro classes @interface @int >>>= ~=", {
+            Token(TokenType::KEYWORD, "throws"),
+            Token(TokenType::IDENTIFIER, "thro"),
+            Token(TokenType::IDENTIFIER, "classes"),
+            Token(TokenType::KEYWORD, "@interface"),
+            Token(TokenType::UNKNOWN, "@int"),
+            Token(TokenType::UNKNOWN, ">>>="),
+            Token(TokenType::OPERATOR, "~="),
+    });
     assertLexer("Lambda Expression", "($arg1)->{/*Comment*/}", {
             Token(TokenType::SYMBOL, "("),
             Token(TokenType::IDENTIFIER, "$arg1"),
@@ -175,10 +320,780 @@ void test_others() {
     });
 }
 
+/**
+ * Checks that `tokenizeFile` produces the same tokens as `tokenize` on the file contents.
+ */
+void assertFileLexer(const std::string &testName, const std::string &input) {
+    auto path = std::filesystem::temp_directory_path() / "simple_java_lexer_test.java";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << input;
+    }
+
+    auto file = tokenizeFile(path.string());
+    std::filesystem::remove(path);
+    if (file.source.contents() != input) {
+        std::cerr << "Test failed (" << testName << "): File contents differ from the input.\n";
+        return;
+    }
+    if (assertViewLexer(testName, file.source.contents(), tokenize(input), file.tokens)) {
+        std::cout << "Test passed (" << testName << ").\n";
+    }
+}
+
+void test_files() {
+    assertFileLexer("Tokenize file", "public class Main {\n    /* comment */ int a = 0x1F;\n}\n");
+    assertFileLexer("Tokenize empty file", "");
+}
+
+void test_streaming() {
+    std::string source = "package a.b;\nimport c.d;\nclass E { int f = 0x1F; }";
+    Lexer lexer(source);
+    int importCount = 0;
+    std::optional<TokenView> token;
+    while ((token = lexer.next()) && token->lexeme != "class") {
+        importCount += token->lexeme == "import";
+    }
+    if (!token || importCount != 1 || token->position.line != 3) {
+        std::cerr << "Test failed (Stop streaming after imports): Did not stop at 'class'.\n";
+        return;
+    }
+
+    auto all = tokenize_view(source);
+    std::vector<TokenView> rest;
+    lexer.drain(rest);
+    if (rest.size() != all.size() - 15 || rest.front().lexeme != all[15].lexeme) {
+        std::cerr << "Test failed (Stop streaming after imports): Drained " << rest.size() << " tokens.\n";
+        return;
+    }
+    std::cout << "Test passed (Stop streaming after imports).\n";
+}
+
+void test_batch() {
+    std::vector<std::string> files;
+    for (int i = 0; i < 64; i++) {
+        std::string file = "class C" + std::to_string(i) + " {\n";
+        for (int j = 0; j < (i % 8) * (i % 8) * 50; j++) {
+            file += "    int f" + std::to_string(j) + " = 0x" + std::to_string(j) + "; /* c */\n";
+        }
+        files.push_back(file + "}\n");
+    }
+    std::vector<std::string_view> sources(files.begin(), files.end());
+
+    ThreadPool pool(4);
+    for (int run = 0; run < 2; run++) {
+        auto results = tokenizeAll(sources, {.pool = &pool});
+        for (int i = 0; i < files.size(); i++) {
+            if (!assertViewLexer("Batch tokenize", files[i], tokenize(files[i]), results[i])) return;
+        }
+    }
+
+    // A failing task does not stop the others, and its exception is rethrown by `run`.
+    std::atomic<size_t> ran = 0;
+    try {
+        std::vector<size_t> order = {0, 1, 2, 3, 4, 5, 6, 7};
+        pool.run(order, [&](size_t task, unsigned) {
+            ran++;
+            if (task == 3) throw std::runtime_error("task 3");
+        });
+        std::cerr << "Test failed (Batch tokenize): A task exception was lost.\n";
+        return;
+    } catch (const std::runtime_error &) {
+        // Expected.
+    }
+    if (ran != 8 || tokenizeAll(sources, {.pool = &pool})[5].size() != tokenize(files[5]).size()) {
+        std::cerr << "Test failed (Batch tokenize): The pool did not recover from a task exception.\n";
+        return;
+    }
+    std::cout << "Test passed (Batch tokenize).\n";
+}
+
+void test_parallel() {
+    std::string source;
+    for (int i = 0; i < 40; i++) {
+        source += "/* comment " + std::to_string(i) + "\n   still // inside \"\n */ int x" + std::to_string(i) + ";\n";
+        source += "  String s = \"a /* b\\\";\n\n";
+        source += "  char c = '\\''; // tail */ /*\n 1_000 /**/ x >>= 0x1F;\n";
+    }
+    source += "/* unterminated\n ...";
+
+    ThreadPool pool(3);
+    std::vector<Token> expected = tokenize(source);
+    for (size_t segmentSize: {1, 17, 64, 1000}) {
+        for (size_t interval: {1, 10, 100}) {
+            auto tokens = tokenizeParallel(source, {.pool = &pool, .segmentSize = segmentSize,
+                    .checkpointInterval = interval});
+            if (!assertViewLexer("Parallel tokenize", source, expected, tokens)) return;
+        }
+    }
+    std::cout << "Test passed (Parallel tokenize).\n";
+}
+
+void test_token_buffer() {
+    std::string source(multi_line_source);
+    TokenBuffer buffer = tokenizeCompact(source);
+    if (!assertTokenViews("Compact tokens", source, buffer)) return;
+
+    std::vector<Token> tokens = tokenize(source);
+    if (buffer.token(5).lexeme != tokens[5].lexeme || buffer.token(5).position.column != tokens[5].position.column) {
+        std::cerr << "Test failed (Compact tokens): Expected " << tokens[5] << ", got " << buffer.token(5) << ".\n";
+        return;
+    }
+    std::cout << "Test passed (Compact tokens).\n";
+}
+
+void test_lazy_positions() {
+    std::string source(multi_line_source);
+    auto tokens = tokenize_view(source, {.trackPositions = false});
+    if (tokens.empty() || tokens.back().position.line != 0 || tokens.back().position.column != 0) {
+        std::cerr << "Test failed (Lazy positions): Positions were tracked.\n";
+        return;
+    }
+    LineIndex(source).resolve(tokens);
+    if (assertViewLexer("Lazy positions", source, tokenize(source), tokens)) {
+        std::cout << "Test passed (Lazy positions).\n";
+    }
+}
+
+void test_filtering() {
+    std::string source = "int a; // x\n/* y */ b = c /* z */+ d;\n";
+    uint32_t types = all_token_types & ~tokenTypeBit(TokenType::WHITESPACE) & ~comment_token_types;
+    std::vector<Token> expected;
+    for (auto &token: tokenize(source)) {
+        if ((types & tokenTypeBit(token.type)) != 0) expected.push_back(token);
+    }
+
+    if (!assertViewLexer("Filter token types", source, expected, tokenize_view(source, {.emitTypes = types}))) return;
+    PushLexer lexer({.emitTypes = types});
+    lexer.feed(source);
+    lexer.finish();
+    std::vector<Token> pushed = lexer.takeTokens();
+    if (pushed.size() != expected.size() || pushed.back().position.index != expected.back().position.index) {
+        std::cerr << "Test failed (Filter token types): PushLexer produced " << pushed.size() << " tokens.\n";
+        return;
+    }
+    std::cout << "Test passed (Filter token types).\n";
+}
+
+void test_reused_output() {
+    std::string large = "class A { String s = \"a long string literal\"; /* and a long comment */ }";
+    std::string small = "int b = 1;";
+    std::vector<Token> tokens;
+    std::vector<TokenView> views;
+
+    tokenize(large, tokens);
+    tokenize_view(large, views);
+    const Token *data = tokens.data();
+    size_t capacity = views.capacity();
+    tokenize(small, tokens);
+    tokenize_view(small, views);
+    if (tokens.data() != data || views.capacity() != capacity) {
+        std::cerr << "Test failed (Reused output): The output was reallocated.\n";
+        return;
+    }
+    if (!assertViewLexer("Reused output", small, tokenize(small), views)) return;
+    if (!assertViewLexer("Reused output", small, tokens, tokenize_view(small))) return;
+    std::cout << "Test passed (Reused output).\n";
+}
+
+void test_owned_tokens() {
+    std::string source = "/** Docs */ class A { String s = \"text\"; }";
+    std::vector<Token> expected = tokenize(source);
+    auto owned = std::make_unique<std::string>(source);
+    OwnedTokens result = tokenizeOwned(*owned, {.emitTypes = ~tokenTypeBit(TokenType::WHITESPACE)});
+    owned.reset();
+
+    std::erase_if(expected, [](const Token &token) { return token.type == TokenType::WHITESPACE; });
+    OwnedTokens moved = std::move(result);
+    bool isEqual = moved.tokens.size() == expected.size();
+    size_t bytes = 0;
+    for (size_t i = 0; isEqual && i < expected.size(); i++) {
+        isEqual = moved.tokens[i].lexeme == expected[i].lexeme &&
+                  moved.tokens[i].position.index == expected[i].position.index;
+        bytes += expected[i].lexeme.size();
+    }
+    if (!isEqual || moved.lexemes.memoryUsage() != bytes) {
+        std::cerr << "Test failed (Owned tokens): Lexemes differ from the source.\n";
+        return;
+    }
+    std::cout << "Test passed (Owned tokens).\n";
+}
+
+void test_incremental() {
+    IncrementalLexer lexer("class A {\n\tint a = b[0];\n\tc(a);\n}");
+    struct {
+        size_t offset;
+        size_t removed;
+        std::string_view inserted;
+    } edits[] = {
+            {15, 1, "total"},       // Rename `a`.
+            {10, 0, "/* "},         // Open a block comment that swallows the rest.
+            {34, 0, " */"},         // Close it on the next line.
+            {10, 3, ""},            // Remove the opening again.
+            {0, 0, "\n\n"},         // Move every line down.
+    };
+    for (const auto &edit: edits) {
+        lexer.edit(edit.offset, edit.removed, edit.inserted);
+        if (!assertTokenViews("Incremental", lexer.getSource(), lexer.tokens())) return;
+    }
+
+    TokenEdit edit = lexer.edit(lexer.getSource().find("total"), 5, "sum");
+    if (edit.removed > 3 || edit.inserted > 3) {
+        std::cerr << "Test failed (Incremental): Re-lexed " << edit.inserted << " tokens for a rename.\n";
+        return;
+    }
+    std::cout << "Test passed (Incremental).\n";
+}
+
+void test_line_snapshots() {
+    std::string source = "class A {\n  /* multi\n line */ int a;\n  int b = 0x1F;\n}\n";
+    std::vector<TokenView> tokens;
+    std::vector<LexerSnapshot> lineSnapshots;
+    tokenize_view(source, tokens, lineSnapshots);
+    if (lineSnapshots.size() != 6 || lineSnapshots[2].state != STATE_BLOCK_COMMENT) {
+        std::cerr << "Test failed (Line snapshots): Expected 6 snapshots with line 3 inside the comment.\n";
+        return;
+    }
+    if (!assertViewLexer("Line snapshots", source, tokenize(source), tokens)) return;
+
+    // Lines 3 and 4: the comment that started on line 2, then everything up to line 5.
+    std::vector<Token> expected;
+    for (const Token &token: tokenize(source)) {
+        if (token.position.index + (int) token.lexeme.size() > lineSnapshots[2].position.index &&
+            token.position.index < lineSnapshots[4].position.index) {
+            expected.push_back(token);
+        }
+    }
+    auto range = tokenizeRange(source, 3, 5, lineSnapshots);
+    if (assertViewLexer("Line snapshots", source, expected, range)) {
+        std::cout << "Test passed (Line snapshots).\n";
+    }
+}
+
+void test_token_cache() {
+    std::string source(multi_line_source);
+    std::string copy = source;
+    auto directory = std::filesystem::temp_directory_path() / "simple_java_lexer_cache";
+    std::filesystem::remove_all(directory);
+
+    TokenCache cache({.capacity = 1, .directory = directory.string()});
+    cache.tokenize(source);
+    TokenBuffer hit = cache.tokenize(copy);
+    TokenCache reopened({.directory = directory.string()});
+    TokenBuffer loaded = reopened.tokenize(copy);
+
+    // Point the first token past the end of the source: the damaged entry must be a miss.
+    for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(TokenStreamHeader));
+        uint32_t offset = (uint32_t) source.size();
+        file.write((const char *) &offset, sizeof offset);
+    }
+    TokenCache damaged({.directory = directory.string()});
+    TokenBuffer relexed = damaged.tokenize(copy);
+    std::filesystem::remove_all(directory);
+
+    TokenCacheStats stats = cache.stats();
+    if (stats.misses != 1 || stats.hits != 1 || reopened.stats().diskHits != 1) {
+        std::cerr << "Test failed (Token cache): Expected one miss, one hit and one disk hit.\n";
+        return;
+    }
+    if (damaged.stats().diskHits != 0 || damaged.stats().misses != 1) {
+        std::cerr << "Test failed (Token cache): A damaged entry was loaded.\n";
+        return;
+    }
+    if (!assertTokenViews("Token cache [damaged]", copy, relexed)) return;
+    if (!assertTokenViews("Token cache", copy, hit)) return;
+    if (assertTokenViews("Token cache [disk]", copy, loaded)) {
+        std::cout << "Test passed (Token cache).\n";
+    }
+}
+
+void test_token_stream() {
+    std::string source(multi_line_source);
+    TokenBuffer buffer = tokenizeCompact(source);
+    auto path = std::filesystem::temp_directory_path() / "simple_java_lexer_test.tokens";
+    saveTokenStream(buffer, path.string());
+    MappedTokenStream stream = loadTokenStream(path.string(), source);
+    if (!assertTokenViews("Token stream", source, stream.tokens)) return;
+
+    std::ostringstream out;
+    writeTokenStream(stream.tokens, out);
+    std::filesystem::remove(path);
+    std::string truncated = out.str().substr(0, out.str().size() - 1);
+    try {
+        readTokenStream(truncated, source);
+        std::cerr << "Test failed (Token stream): A truncated stream was accepted.\n";
+        return;
+    } catch (const std::runtime_error &) {
+        // Expected.
+    }
+    std::cout << "Test passed (Token stream).\n";
+}
+
+void test_interner() {
+    std::string_view sources[] = {"class A { String name; }", "class B { String a = name; }"};
+    IdentifierInterner interner(4);
+    auto results = tokenizeAll(sources, {.interner = &interner});
+
+    std::vector<uint32_t> ids;
+    for (const auto &tokens: results) {
+        for (const TokenView &token: tokens) {
+            bool isIdentifier = token.type == TokenType::IDENTIFIER;
+            if (isIdentifier != (token.id != no_identifier_id) ||
+                (isIdentifier && interner.name(token.id) != token.lexeme)) {
+                std::cerr << "Test failed (Identifier interner): Wrong id " << token.id << " for " << token << ".\n";
+                return;
+            }
+            if (isIdentifier) ids.push_back(token.id);
+        }
+    }
+    // A, String, name | B, String, a, name
+    if (interner.size() != 5 || ids.size() != 7 || ids[1] != ids[4] || ids[2] != ids[6]) {
+        std::cerr << "Test failed (Identifier interner): Expected 5 distinct ids shared by both files.\n";
+        return;
+    }
+    std::vector<Token> tokens = tokenize("String name;", {.interner = &interner});
+    if (tokens[0].id != ids[1] || tokens[2].id != ids[2]) {
+        std::cerr << "Test failed (Identifier interner): Owned tokens lost their ids.\n";
+        return;
+    }
+    // Contextual keywords are also valid identifiers, so `var` gets the same id either way.
+    uint32_t varId = interner.intern("var");
+    std::vector<TokenView> words = tokenize_view("var x; non-sealed", {.interner = &interner});
+    std::vector<TokenView> dfaWords = tokenize_view("var x; non-sealed", {.interner = &interner,
+                                                                          .engine = LexerEngine::DFA});
+    if (words[0].id != varId || dfaWords[0].id != varId ||
+        words.back().id != no_identifier_id || dfaWords.back().id != no_identifier_id) {
+        std::cerr << "Test failed (Identifier interner): Wrong ids for contextual keywords.\n";
+        return;
+    }
+    std::cout << "Test passed (Identifier interner).\n";
+}
+
+void test_number_values() {
+    std::string source = "3_1.1___141_592_653 0b1_______1 017 0xFFFFFFFF 2147483648 12L 1.5f 1e400 08";
+    struct {
+        NumberKind kind;
+        bool overflow;
+        double value;
+    } expected[] = {
+            {NumberKind::DOUBLE, false, 31.1141592653},
+            {NumberKind::INT,    false, 3},
+            {NumberKind::INT,    false, 15},
+            {NumberKind::INT,    false, -1},
+            {NumberKind::INT,    true,  2147483648.0},
+            {NumberKind::LONG,   false, 12},
+            {NumberKind::FLOAT,  false, 1.5},
+            {NumberKind::DOUBLE, true,  HUGE_VAL},
+            {NumberKind::NONE,   false, 0},
+    };
+    auto tokens = tokenize_view(source, {.emitTypes = ~tokenTypeBit(TokenType::WHITESPACE), .parseNumbers = true});
+    for (size_t i = 0; i < tokens.size(); i++) {
+        const TokenView &token = tokens[i];
+        bool isInteger = token.numberKind == NumberKind::INT || token.numberKind == NumberKind::LONG;
+        double value = isInteger ? (double) token.number.integer :
+                       token.numberKind == NumberKind::NONE ? 0 : token.number.floating;
+        if (i >= std::size(expected) || token.numberKind != expected[i].kind ||
+            token.numberOverflow != expected[i].overflow || value != expected[i].value) {
+            std::cerr << "Test failed (Number values): Wrong value for " << token << ".\n";
+            return;
+        }
+    }
+    if (tokens.size() != std::size(expected) || tokenize(source)[0].numberKind != NumberKind::NONE) {
+        std::cerr << "Test failed (Number values): Values must only be computed on request.\n";
+        return;
+    }
+    std::cout << "Test passed (Number values).\n";
+}
+
+void test_dfa_engine() {
+    std::string inputs[] = {
+            "/*/ a */ /* unclosed\n", "/* unclosed", "\"a\\\\\" b\n'\\'' \"open\nx",
+            "1_000 1__ 0x_1 0b12 0xL 1e+ 1e5.5f 1.e3 .5d 1..2 08l 1e_5 1_",
+            "a>>>=b ===c !!d ++++e -->f ->g /=h //x\n", "@interface @class @1 @_ @a :: ::: @",
+            "\t\n x \r\n\f y # \x80 ` \\",
+    };
+    LexOptions variants[] = {
+            {},
+            {.trackPositions = false},
+            {.emitTypes = ~tokenTypeBit(TokenType::WHITESPACE), .parseNumbers = true},
+    };
+    for (const std::string &input: inputs) {
+        for (LexOptions options: variants) {
+            std::vector<Token> expected;
+            for (const TokenView &token: tokenize_view(input, options)) {
+                expected.emplace_back(token);
+            }
+            options.engine = LexerEngine::DFA;
+            std::vector<TokenView> tokens = tokenize_view(input, options);
+            if (!assertViewLexer("DFA engine", input, expected, tokens)) return;
+            for (size_t i = 0; i < tokens.size(); i++) {
+                if (tokens[i].numberKind != expected[i].numberKind ||
+                    tokens[i].number.integer != expected[i].number.integer) {
+                    std::cerr << "Test failed (DFA engine): Wrong value for " << tokens[i] << ".\n";
+                    return;
+                }
+            }
+        }
+        std::vector<Token> owned = tokenize(input, {.engine = LexerEngine::DFA});
+        if (!assertViewLexer("DFA engine [tokenize]", input, owned, tokenize_view(input))) return;
+    }
+    std::cout << "Test passed (DFA engine).\n";
+}
+
+void test_unicode() {
+    assertLexer("UTF-8 identifiers", "int größe = 名前 + π2;", {
+            Token(TokenType::KEYWORD, "int"),
+            Token(TokenType::IDENTIFIER, "größe"),
+            Token(TokenType::OPERATOR, "="),
+            Token(TokenType::IDENTIFIER, "名前"),
+            Token(TokenType::OPERATOR, "+"),
+            Token(TokenType::IDENTIFIER, "π2"),
+            Token(TokenType::SYMBOL, ";"),
+    });
+    assertLexer("UTF-8 annotation and currency", "@Überschrift €uro $\\u00e9", {
+            Token(TokenType::ANNOTATION, "@Überschrift"),
+            Token(TokenType::IDENTIFIER, "€uro"),
+            Token(TokenType::IDENTIFIER, "$\\u00e9"),
+    });
+    assertLexer("Unicode escapes", "\\u0061b c\\uuu00e9 @\\u0041 \\u0069f x\\uD835\\uDC00", {
+            Token(TokenType::IDENTIFIER, "\\u0061b"),
+            Token(TokenType::IDENTIFIER, "c\\uuu00e9"),
+            Token(TokenType::ANNOTATION, "@\\u0041"),
+            Token(TokenType::IDENTIFIER, "\\u0069f"),
+            Token(TokenType::IDENTIFIER, "x\\uD835\\uDC00"),
+    });
+    assertLexer("Invalid Unicode escapes", "a\\u00 b\\uD835 \\u0030", {
+            Token(TokenType::IDENTIFIER, "a"),
+            Token(TokenType::UNKNOWN, "\\"),
+            Token(TokenType::IDENTIFIER, "u00"),
+            Token(TokenType::IDENTIFIER, "b"),
+            Token(TokenType::UNKNOWN, "\\"),
+            Token(TokenType::IDENTIFIER, "uD835"),
+            Token(TokenType::UNKNOWN, "\\"),
+            Token(TokenType::IDENTIFIER, "u0030"),
+    });
+    assertLexer("Non-identifier characters", "a → e\xcc\x81 \xcc\x81x \xc3 \xff\xc0\xaf", {
+            Token(TokenType::IDENTIFIER, "a"),
+            Token(TokenType::UNKNOWN, "→"),
+            Token(TokenType::IDENTIFIER, "e\xcc\x81"),
+            Token(TokenType::UNKNOWN, "\xcc\x81"),
+            Token(TokenType::IDENTIFIER, "x"),
+            Token(TokenType::UNKNOWN, "\xc3"),
+            Token(TokenType::UNKNOWN, "\xff"),
+            Token(TokenType::UNKNOWN, "\xc0"),
+            Token(TokenType::UNKNOWN, "\xaf"),
+    });
+}
+
+void test_text_blocks() {
+    assertLexer("Text block", "String s = \"\"\"\n    Hello, \"World\"!\n    \"\"\";\nint a;", {
+            Token(TokenType::IDENTIFIER, "String"),
+            Token(TokenType::IDENTIFIER, "s"),
+            Token(TokenType::OPERATOR, "="),
+            Token(TokenType::TEXT_BLOCK, "\"\"\"\n    Hello, \"World\"!\n    \"\"\""),
+            Token(TokenType::SYMBOL, ";"),
+            Token(TokenType::KEYWORD, "int"),
+            Token(TokenType::IDENTIFIER, "a"),
+            Token(TokenType::SYMBOL, ";"),
+    });
+    assertLexer("Text block with escaped quotes", R"("""
+a\"""b\\""" x)", {
+            Token(TokenType::TEXT_BLOCK, "\"\"\"\na\\\"\"\"b\\\\\"\"\""),
+            Token(TokenType::IDENTIFIER, "x"),
+    });
+    assertLexer("Empty strings and text blocks", "\"\" \"\"\"\"\"\" \"\"\"\"\"\"\"", {
+            Token(TokenType::STRING, "\"\""),
+            Token(TokenType::TEXT_BLOCK, "\"\"\"\"\"\""),
+            Token(TokenType::TEXT_BLOCK, "\"\"\"\"\"\""),
+            Token(TokenType::UNKNOWN, "\""),
+    });
+    assertLexer("Unterminated text block", "\"\"\"\n/* not a comment", {
+            Token(TokenType::UNKNOWN, "\"\"\"\n/* not a comment"),
+    });
+
+    std::string source;
+    for (int i = 0; i < 20; i++) {
+        source += "String s" + std::to_string(i) + " = \"\"\"\n  /* \" \"\" \\\"\"\"\n\"\"\"; // \"\"\"\n";
+    }
+    ThreadPool pool(3);
+    std::vector<Token> expected = tokenize(source);
+    for (size_t segmentSize: {1, 17, 64}) {
+        auto tokens = tokenizeParallel(source, {.pool = &pool, .segmentSize = segmentSize, .checkpointInterval = 8});
+        if (!assertViewLexer("Parallel text blocks", source, expected, tokens)) return;
+    }
+    std::cout << "Test passed (Parallel text blocks).\n";
+}
+
+void test_contextual_keywords() {
+    assertLexer("Contextual keywords",
+                "sealed interface S permits A {}\nnon-sealed class A {}\nrecord P(var x) { yield; }", {
+            Token(TokenType::CONTEXTUAL_KEYWORD, "sealed"),
+            Token(TokenType::KEYWORD, "interface"),
+            Token(TokenType::IDENTIFIER, "S"),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "permits"),
+            Token(TokenType::IDENTIFIER, "A"),
+            Token(TokenType::SYMBOL, "{"),
+            Token(TokenType::SYMBOL, "}"),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "non-sealed"),
+            Token(TokenType::KEYWORD, "class"),
+            Token(TokenType::IDENTIFIER, "A"),
+            Token(TokenType::SYMBOL, "{"),
+            Token(TokenType::SYMBOL, "}"),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "record"),
+            Token(TokenType::IDENTIFIER, "P"),
+            Token(TokenType::SYMBOL, "("),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "var"),
+            Token(TokenType::IDENTIFIER, "x"),
+            Token(TokenType::SYMBOL, ")"),
+            Token(TokenType::SYMBOL, "{"),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "yield"),
+            Token(TokenType::SYMBOL, ";"),
+            Token(TokenType::SYMBOL, "}"),
+    });
+    assertLexer("Almost non-sealed", "non-sealedX non - sealed nonsealed @record non-sealed\\u0061", {
+            Token(TokenType::IDENTIFIER, "non"),
+            Token(TokenType::OPERATOR, "-"),
+            Token(TokenType::IDENTIFIER, "sealedX"),
+            Token(TokenType::IDENTIFIER, "non"),
+            Token(TokenType::OPERATOR, "-"),
+            Token(TokenType::CONTEXTUAL_KEYWORD, "sealed"),
+            Token(TokenType::IDENTIFIER, "nonsealed"),
+            Token(TokenType::ANNOTATION, "@record"),
+            Token(TokenType::IDENTIFIER, "non"),
+            Token(TokenType::OPERATOR, "-"),
+            Token(TokenType::IDENTIFIER, "sealed\\u0061"),
+    });
+
+    IncrementalLexer lexer("non-sealedX class");
+    lexer.edit(10, 1, "");
+    if (assertTokenViews("Incremental non-sealed", lexer.getSource(), lexer.tokens())) {
+        std::cout << "Test passed (Incremental non-sealed).\n";
+    }
+}
+
+void test_line_cache() {
+    // Generated files whose lines repeat, also across files, with lines that are entered inside a
+    // block comment or text block, or after a line comment, which must not reuse cached tokens.
+    std::vector<std::string> files;
+    for (int i = 0; i < 16; i++) {
+        std::string file = "class G" + std::to_string(i % 4) + " {\n";
+        for (int j = 0; j < 40; j++) {
+            file += j % 7 == 0 ? "    /* x = 1;\n    x = 1;\n */ x = 1;\n" : "    x = 1;\n";
+            file += j % 5 == 0 ? "    // x = 1;\n    x = 1;\n" : "\n";
+            file += j % 9 == 0 ? "    s = \"\"\"\n    x = 1;\n    \"\"\";\n" : "    f(x, \"s\");\n";
+        }
+        files.push_back(file + (i % 2 == 0 ? "}\n" : "} /* open\n"));
+    }
+    std::vector<std::string_view> sources(files.begin(), files.end());
+
+    ThreadPool pool(2);
+    for (size_t lineCacheSize: {2, 1024}) {
+        auto results = tokenizeAll(sources, {.pool = &pool, .lineCacheSize = lineCacheSize});
+        for (int i = 0; i < files.size(); i++) {
+            if (!assertViewLexer("Batch line cache", files[i], tokenize(files[i]), results[i])) return;
+        }
+    }
+    std::cout << "Test passed (Batch line cache).\n";
+}
+
+extern "C" const char *check_c_api(void);
+
+void test_c_api() {
+    if (const char *failure = check_c_api()) {
+        std::cerr << "Test failed (C API): " << failure << ".\n";
+        return;
+    }
+
+    // One handle lexes several sources into reused arrays, with positions, on both engines.
+    std::string sources[] = {"class A {\n  int x = 0x1F; // c\n}\n", "", "\"\"\"\n  text\n  \"\"\" + /* open"};
+    for (uint32_t engine: {SJL_ENGINE_STATE_MACHINE, SJL_ENGINE_DFA}) {
+        sjl_options options = {0, engine};
+        sjl_lexer *lexer = sjl_lexer_create(&options);
+        std::vector<uint8_t> types(64);
+        std::vector<uint32_t> offsets(64), lengths(64), lines(64), columns(64);
+        for (const std::string &source: sources) {
+            sjl_tokens tokens = {types.data(), offsets.data(), lengths.data(), lines.data(), columns.data(), 64, 0};
+            auto expected = tokenize(source);
+            if (sjl_tokenize_into(lexer, source.data(), source.size(), &tokens) != SJL_OK ||
+                tokens.count != expected.size()) {
+                std::cerr << "Test failed (C API): Produced " << tokens.count << " tokens for '" << source << "'.\n";
+                sjl_free(lexer);
+                return;
+            }
+            for (size_t i = 0; i < tokens.count; i++) {
+                const Token &token = expected[i];
+                if (types[i] != token.type || offsets[i] != token.position.index ||
+                    source.substr(offsets[i], lengths[i]) != token.lexeme ||
+                    lines[i] != token.position.line || columns[i] != token.position.column) {
+                    std::cerr << "Test failed (C API): Token " << i << " differs from " << token << ".\n";
+                    sjl_free(lexer);
+                    return;
+                }
+            }
+        }
+        sjl_free(lexer);
+    }
+
+    // A token stream is read back without copying, and keeps the emitted types of the handle.
+    sjl_options comments = {comment_token_types, SJL_ENGINE_STATE_MACHINE};
+    sjl_lexer *lexer = sjl_lexer_create(&comments);
+    const std::string &source = sources[0];
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    if (sjl_tokenize_stream(lexer, source.data(), source.size(), &data, &size) != SJL_OK) {
+        std::cerr << "Test failed (C API): No token stream.\n";
+        sjl_free(lexer);
+        return;
+    }
+    TokenBufferView view = readTokenStream({(const char *) data, size}, source);
+    bool isValid = view.size() == 1 && view.lexeme(0) == "// c" && view.position(0).line == 2;
+    // Positions are `int` indices, so the length is rejected before the source is read.
+    sjl_status tooLarge = sjl_tokenize_stream(lexer, source.data(), (size_t) INT32_MAX + 1, &data, &size);
+    sjl_free(lexer);
+    if (!isValid) {
+        std::cerr << "Test failed (C API): Token stream has " << view.size() << " tokens.\n";
+        return;
+    }
+    if (tooLarge != SJL_ERROR_TOO_LARGE) {
+        std::cerr << "Test failed (C API): A source of 2 GiB was accepted.\n";
+        return;
+    }
+    std::cout << "Test passed (C API).\n";
+}
+
+void test_pipeline() {
+    // Files of many sizes, whose tokens span chunks and blocks, one of them empty.
+    auto directory = std::filesystem::temp_directory_path() / "simple_java_lexer_pipeline";
+    std::filesystem::create_directories(directory);
+    std::vector<std::string> paths, sources;
+    for (int i = 0; i < 12; i++) {
+        std::string source;
+        for (int j = 0; j < i * i * 20; j++) {
+            source += "int v" + std::to_string(j) + " = 0x1F; /* c */ s = \"text\";\n";
+        }
+        sources.push_back(i == 0 ? "" : source + (i % 2 == 0 ? "// end" : "\"\"\"\n open"));
+        paths.push_back((directory / ("File" + std::to_string(i) + ".java")).string());
+        std::ofstream(paths.back(), std::ios::binary) << sources.back();
+    }
+
+    for (bool useIoUring: {true, false}) {
+        std::string name = useIoUring ? "Pipeline" : "Pipeline [I/O threads]";
+        PipelineOptions options{.threads = 2, .openFiles = 3, .chunkSize = 7, .blockSize = 5, .queuedBlocks = 2,
+                                .useIoUring = useIoUring};
+        std::vector<std::vector<Token>> results(paths.size());
+        std::vector<bool> isDone(paths.size());
+        bool isOrdered = true;
+        PipelineStats stats = tokenizePipeline(paths, [&](TokenBlock &block) {
+            isOrdered &= !isDone[block.file] && block.first == results[block.file].size() &&
+                         (block.last || block.tokens.size() == 5);
+            std::move(block.tokens.begin(), block.tokens.end(), std::back_inserter(results[block.file]));
+            isDone[block.file] = block.last;
+        }, options);
+        if (!isOrdered || stats.files != paths.size() || std::count(isDone.begin(), isDone.end(), true) != 12) {
+            std::cerr << "Test failed (" << name << "): Blocks of a file arrived out of order.\n";
+            std::filesystem::remove_all(directory);
+            return;
+        }
+        for (size_t i = 0; i < paths.size(); i++) {
+            auto expected = tokenize(sources[i]);
+            bool isEqual = results[i].size() == expected.size();
+            for (size_t j = 0; isEqual && j < expected.size(); j++) {
+                isEqual = results[i][j].type == expected[j].type && results[i][j].lexeme == expected[j].lexeme &&
+                          results[i][j].position.line == expected[j].position.line &&
+                          results[i][j].position.column == expected[j].position.column;
+            }
+            if (!isEqual) {
+                std::cerr << "Test failed (" << name << "): Tokens of file " << i << " differ.\n";
+                std::filesystem::remove_all(directory);
+                return;
+            }
+        }
+        std::cout << "Test passed (" << name << ").\n";
+    }
+
+    // A missing file fails the run once the others are lexed; a failing sink stops it.
+    std::vector<std::string> withMissing = {paths[3], (directory / "Missing.java").string(), paths[4]};
+    size_t completed = 0;
+    try {
+        tokenizePipeline(withMissing, [&](TokenBlock &block) { completed += block.last; });
+        std::cerr << "Test failed (Pipeline errors): A missing file was not reported.\n";
+    } catch (const std::system_error &) {
+        try {
+            tokenizePipeline(paths, [](TokenBlock &) { throw std::runtime_error("sink"); });
+            std::cerr << "Test failed (Pipeline errors): The error of the sink was not rethrown.\n";
+        } catch (const std::runtime_error &error) {
+            if (completed != 2 || std::string(error.what()) != "sink") {
+                std::cerr << "Test failed (Pipeline errors): Lexed " << completed << " files besides the missing one.\n";
+            } else {
+                std::cout << "Test passed (Pipeline errors).\n";
+            }
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
+
+void test_summary() {
+    std::string source = "/* Header\n   comment */\npackage com.example.record;\n\n"
+                         "import java.util.*;\nimport static java.lang.Math.max; // max\r\n"
+                         "class A {\n    String s = \"\"\"\n        text\n        \"\"\";\n}";
+    SourceSummary summary = summarize(source);
+    std::array<size_t, TokenType::UNKNOWN + 1> counts{};
+    auto tokens = tokenize(source);
+    for (const Token &token: tokens) {
+        counts[token.type]++;
+    }
+    if (summary.tokenCounts != counts || summary.tokens != tokens.size()) {
+        std::cerr << "Test failed (Summary): Token counts differ from tokenize.\n";
+        return;
+    }
+    if (summary.lines != 11 || summary.codeLines != 8 || summary.commentLines != 2 || summary.blankLines != 1 ||
+        summary.longestLine != 40 || summary.longestLineNumber != 6 || summary.commentToCodeRatio() != 0.25) {
+        std::cerr << "Test failed (Summary): Lines " << summary.lines << ", code " << summary.codeLines
+                  << ", comments " << summary.commentLines << ", longest " << summary.longestLine << ".\n";
+        return;
+    }
+    if (summary.packageName != "com.example.record" || summary.importCount != 2 || summary.staticImportCount != 1 ||
+        summary.imports[0] != "java.util.*" || summary.imports[1] != "java.lang.Math.max") {
+        std::cerr << "Test failed (Summary): Package '" << summary.packageName << "' or imports differ.\n";
+        return;
+    }
+    SourceSummary empty = summarize("");
+    if (empty.lines != 0 || empty.tokens != 0 || empty.longestLineNumber != 0 || summarize("a\n").lines != 1) {
+        std::cerr << "Test failed (Summary): Lines of an empty source.\n";
+        return;
+    }
+    std::cout << "Test passed (Summary).\n";
+}
+
 void test_lexer() {
     test_operators();
     test_strings();
     test_numbers();
     test_comments();
     test_others();
+    test_files();
+    test_streaming();
+    test_batch();
+    test_parallel();
+    test_token_buffer();
+    test_lazy_positions();
+    test_filtering();
+    test_reused_output();
+    test_owned_tokens();
+    test_incremental();
+    test_line_snapshots();
+    test_token_cache();
+    test_token_stream();
+    test_interner();
+    test_number_values();
+    test_dfa_engine();
+    test_unicode();
+    test_text_blocks();
+    test_contextual_keywords();
+    test_line_cache();
+    test_c_api();
+    test_pipeline();
+    test_summary();
 }
\ No newline at end of file
@@ -29,10 +29,8 @@ int main() {
         }
     )";
 
-    auto tokens = tokenize(source_code);
+    auto tokens = tokenize(source_code, {.emitTypes = all_token_types & ~tokenTypeBit(TokenType::WHITESPACE)});
     for (const auto &token: tokens) {
-        if (token.type == TokenType::WHITESPACE) continue;
-
         std::cout << token << std::endl;
     }
     return 0;
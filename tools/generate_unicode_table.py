@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Generates src/unicode_table.inc, the two-level table of Java identifier characters.
+
+A code point is an identifier start if `Character.isJavaIdentifierStart` accepts it (letters,
+letter numbers, currency symbols and connector punctuation), and an identifier part if
+`Character.isJavaIdentifierPart` does (starts, digits, combining marks, format characters and the
+C1 controls). The table is split into blocks of 256 code points; identical blocks are stored once,
+and a first-level array maps every block to its bitmaps.
+
+Usage: python3 tools/generate_unicode_table.py > src/unicode_table.inc
+"""
+
+import unicodedata
+
+BLOCK_SIZE = 256
+START_CATEGORIES = {"Lu", "Ll", "Lt", "Lm", "Lo", "Nl", "Sc", "Pc"}
+PART_CATEGORIES = START_CATEGORIES | {"Nd", "Mn", "Mc", "Cf"}
+
+
+def flags(code_point):
+    if 0xD800 <= code_point <= 0xDFFF:
+        return False, False
+    category = unicodedata.category(chr(code_point))
+    is_start = category in START_CATEGORIES
+    is_part = category in PART_CATEGORIES or 0x7F <= code_point <= 0x9F
+    return is_start, is_part
+
+
+def bitmap(bits):
+    words = []
+    for i in range(0, BLOCK_SIZE, 64):
+        words.append(sum(1 << j for j in range(64) if bits[i + j]))
+    return ", ".join(f"0x{word:016X}" for word in words)
+
+
+def main():
+    blocks = {}
+    indices = []
+    for block in range(0x110000 // BLOCK_SIZE):
+        code_points = [flags(block * BLOCK_SIZE + i) for i in range(BLOCK_SIZE)]
+        key = (tuple(start for start, _ in code_points), tuple(part for _, part in code_points))
+        indices.append(blocks.setdefault(key, len(blocks)))
+    assert len(blocks) <= 256
+
+    print(f"// Generated by tools/generate_unicode_table.py from Unicode {unicodedata.unidata_version}; do not edit.")
+    print()
+    print(f"inline constexpr size_t unicode_block_count = {len(blocks)};")
+    print()
+    print("// Index into the bitmaps of every block of 256 code points.")
+    print(f"inline constexpr uint8_t unicode_block_index[{len(indices)}] = {{")
+    for i in range(0, len(indices), 24):
+        print("        " + ", ".join(str(index) for index in indices[i:i + 24]) + ",")
+    print("};")
+    for name, position in (("start", 0), ("part", 1)):
+        print()
+        print(f"// Bit `c % 256` of a block is set if `c` is an identifier {name}.")
+        print(f"inline constexpr uint64_t unicode_identifier_{name}[unicode_block_count][4] = {{")
+        for key in blocks:
+            print(f"        {{{bitmap(key[position])}}},")
+        print("};")
+
+
+if __name__ == "__main__":
+    main()